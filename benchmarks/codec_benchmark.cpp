@@ -0,0 +1,69 @@
+/**
+ * @file codec_benchmark.cpp
+ * @brief Throughput of RowCodec decode/encode for each instruction set
+ */
+
+#include "RowCodec.hpp"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr int kWidth = 4096;   ///< Pixels per row
+constexpr int kRows = 1024;    ///< Rows per pass
+constexpr int kPasses = 8;     ///< Timed passes (after one warm-up)
+
+/**
+ * @brief Times a row function over the benchmark image
+ * @return Best pass time in seconds
+ */
+template <typename Fn>
+double timeRows(Fn&& fn) {
+    double best = 1e30;
+    for (int pass = 0; pass <= kPasses; ++pass) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int y = 0; y < kRows; ++y) fn(y);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (pass > 0 && elapsed.count() < best) best = elapsed.count();
+    }
+    return best;
+}
+
+void report(const char* isa, const char* op, const char* format, size_t bytes, double seconds) {
+    const double pixels = static_cast<double>(kWidth) * kRows;
+    std::printf("%-8s %-7s %-7s %10.1f MPix/s %8.2f GB/s\n",
+                isa, op, format, pixels / seconds / 1e6, bytes / seconds / 1e9);
+}
+
+} // namespace
+
+int main() {
+    using Format = BMPFile::PixelFormat;
+
+    std::vector<uint8_t> disk(static_cast<size_t>(kWidth) * kRows * 4);
+    std::vector<BMPFile::Pixel> pixels(static_cast<size_t>(kWidth) * kRows);
+    for (size_t i = 0; i < disk.size(); ++i) disk[i] = static_cast<uint8_t>(i * 31 + 7);
+
+    std::printf("%-8s %-7s %-7s %17s %13s\n", "isa", "op", "format", "pixels", "bandwidth");
+    for (auto isa : {RowCodec::Isa::Scalar, RowCodec::Isa::SSSE3, RowCodec::Isa::AVX2}) {
+        const RowCodec* codec = RowCodec::forIsa(isa);
+        if (!codec) continue;
+
+        for (auto format : {Format::BGR24, Format::BGRA32}) {
+            const size_t bpp = format == Format::BGR24 ? 3 : 4;
+            const size_t row_bytes = kWidth * bpp;
+            const size_t bytes = (row_bytes + kWidth * sizeof(BMPFile::Pixel)) * kRows;
+            const char* name = format == Format::BGR24 ? "bgr24" : "bgra32";
+
+            report(codec->name(), "decode", name, bytes, timeRows([&](int y) {
+                codec->decode(format, disk.data() + y * row_bytes, pixels.data() + y * kWidth, kWidth);
+            }));
+            report(codec->name(), "encode", name, bytes, timeRows([&](int y) {
+                codec->encode(format, pixels.data() + y * kWidth, disk.data() + y * row_bytes, kWidth);
+            }));
+        }
+    }
+    std::printf("selected: %s\n", RowCodec::get().name());
+    return 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file pipeline_benchmark.cpp
+ * @brief Wall time of the processing pipeline in unfused and fused modes
+ */
+
+#include "BMPProcessor.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+constexpr int kSize = 4096;    ///< Width and height of the synthetic image
+constexpr int kRuns = 5;       ///< Timed runs per configuration (best is reported)
+
+/**
+ * @brief Writes a synthetic gradient image
+ * @param path Output path
+ * @param format Pixel format
+ */
+void writeInput(const std::string& path, BMPFile::PixelFormat format) {
+    BMPFile image;
+    image.create(kSize, kSize, format, BMPFile::Pixel{}, BMPFile::Storage::Native);
+    for (int y = 0; y < kSize; ++y) {
+        uint8_t* row = image.rowData(y);
+        const size_t bpp = format == BMPFile::PixelFormat::BGRA32 ? 4 : 3;
+        for (int x = 0; x < kSize; ++x) {
+            row[x * bpp] = static_cast<uint8_t>(x);
+            row[x * bpp + 1] = static_cast<uint8_t>(y);
+            row[x * bpp + 2] = static_cast<uint8_t>(x ^ y);
+        }
+    }
+    image.save(path);
+}
+
+/**
+ * @brief Runs the processor and reports the best wall time
+ */
+void run(const char* label, BMPProcessor::Config config) {
+    double best = 1e30;
+    for (int i = 0; i < kRuns; ++i) {
+        auto strategy = DrawStrategyFactory::create(config.strategy_type);
+        BMPProcessor processor(config, std::move(strategy));
+
+        const auto start = std::chrono::steady_clock::now();
+        if (!processor.process()) {
+            std::printf("%-24s failed\n", label);
+            return;
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best) best = elapsed.count();
+    }
+
+    const double pixels = static_cast<double>(kSize) * kSize;
+    std::printf("%-24s %8.1f ms %10.1f MPix/s\n", label, best * 1e3, pixels / best / 1e6);
+}
+
+} // namespace
+
+int main() {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path();
+
+    for (auto format : {BMPFile::PixelFormat::BGR24, BMPFile::PixelFormat::BGRA32}) {
+        const bool bgra = format == BMPFile::PixelFormat::BGRA32;
+        const std::string input = (dir / (bgra ? "bmp_bench_in32.bmp" : "bmp_bench_in24.bmp")).string();
+        writeInput(input, format);
+        std::printf("%s %dx%d\n", bgra ? "bgra32" : "bgr24", kSize, kSize);
+
+        BMPProcessor::Config config;
+        config.input_file = input;
+        config.output_file = (dir / "bmp_bench_out.bmp").string();
+        config.thickness = 3;
+
+        for (bool fused : {false, true}) {
+            config.fused = fused;
+            const std::string mode = fused ? "fused" : "unfused";
+
+            config.use_mmap = false;
+            config.storage = BMPFile::Storage::Unpacked;
+            run((mode + " unpacked").c_str(), config);
+
+            config.storage = BMPFile::Storage::Native;
+            run((mode + " native").c_str(), config);
+
+            config.use_mmap = true;
+            run((mode + " mmap").c_str(), config);
+        }
+        fs::remove(input);
+    }
+    fs::remove(dir / "bmp_bench_out.bmp");
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file stage_benchmark.cpp
+ * @brief Per-stage and per-strategy throughput over a size and format matrix
+ *
+ * Prints one CSV record per measurement:
+ * stage,variant,format,width,height,thickness,seconds,mpix_per_s,gb_per_s
+ * where seconds is the best of several runs and GB/s counts file bytes
+ * for I/O stages, pixel buffer bytes for other in-memory stages and only
+ * the pixels written for draw records.
+ */
+
+#include "DrawStrategyFactory.hpp"
+#include "Stats.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+const int kSizes[] = {512, 2048, 4096};          ///< Square image sizes
+const unsigned kThicknesses[] = {1, 3, 7, 15};  ///< Stroke widths to draw with
+int runs = 5;                                   ///< Timed runs per record (best is reported)
+
+/**
+ * @brief Times a callable
+ * @return Best wall time in seconds over all runs
+ */
+template <typename Fn>
+double best(Fn&& fn) {
+    double result = 1e30;
+    for (int i = 0; i < runs; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < result) result = elapsed.count();
+    }
+    return result;
+}
+
+void report(const char* stage, const std::string& variant, const char* format,
+            int size, unsigned thickness, double seconds, double bytes) {
+    const double pixels = static_cast<double>(size) * size;
+    std::printf("%s,%s,%s,%d,%d,%u,%.6f,%.1f,%.3f\n", stage, variant.c_str(), format, size, size,
+                thickness, seconds, pixels / seconds / 1e6, bytes / seconds / 1e9);
+    std::fflush(stdout);
+}
+
+/**
+ * @brief Fills an image with a gradient so thresholding sees both outcomes
+ */
+void fillGradient(BMPFile& image) {
+    const int w = image.width();
+    for (int y = 0; y < image.height(); ++y) {
+        BMPFile::Pixel* row = image.row(y);
+        for (int x = 0; x < w; ++x) {
+            row[x] = BMPFile::Pixel(static_cast<uint8_t>(x), static_cast<uint8_t>(y),
+                                    static_cast<uint8_t>(x ^ y));
+        }
+    }
+}
+
+/**
+ * @brief Counts the pixels one draw writes
+ * @return Pixels touched, as reported by the strategy to Stats
+ */
+double drawnPixels(IDrawStrategy& strategy, BMPFile& image) {
+    Stats::setEnabled(true);
+    strategy.draw(image);
+    const double pixels = static_cast<double>(Stats::get(Stats::Counter::PixelsTouched));
+    Stats::setEnabled(false);
+    return pixels;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool quick = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+            runs = 2;
+        } else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::fprintf(stderr, "Usage: %s [--quick] [--runs n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const fs::path path = fs::temp_directory_path() / "bmp_stage_bench.bmp";
+    const std::pair<DrawStrategyFactory::StrategyType, const char*> strategies[] = {
+        {DrawStrategyFactory::StrategyType::NONE, "none"},
+        {DrawStrategyFactory::StrategyType::OPENMP, "openmp"},
+        {DrawStrategyFactory::StrategyType::THREAD, "thread"}
+    };
+
+    std::printf("stage,variant,format,width,height,thickness,seconds,mpix_per_s,gb_per_s\n");
+
+    for (int size : kSizes) {
+        if (quick && size > 512) break;
+
+        for (auto format : {BMPFile::PixelFormat::BGR24, BMPFile::PixelFormat::BGRA32}) {
+            const char* name = format == BMPFile::PixelFormat::BGRA32 ? "bgra32" : "bgr24";
+            const double pixel_bytes = static_cast<double>(size) * size * sizeof(BMPFile::Pixel);
+            const double file_bytes = static_cast<double>(BMPFile::rowSize(size, format)) * size;
+
+            BMPFile image;
+            report("create", "unpacked", name, size, 0, best([&] {
+                image.create(size, size, format, BMPFile::Pixel{});
+            }), pixel_bytes);
+            fillGradient(image);
+
+            for (const auto& [type, label] : strategies) {
+                auto strategy = DrawStrategyFactory::create(type);
+                for (unsigned thickness : kThicknesses) {
+                    strategy->setThickness(thickness);
+                    const double drawn_bytes = drawnPixels(*strategy, image) * sizeof(BMPFile::Pixel);
+                    report("draw", label, name, size, thickness, best([&] {
+                        strategy->draw(image);
+                    }), drawn_bytes);
+                }
+            }
+
+            report("save", "sync", name, size, 0, best([&] {
+                image.save(path.string());
+            }), file_bytes);
+
+            AsyncFileWriter::Options options;
+            report("save", "async", name, size, 0, best([&] {
+                image.saveAsync(path.string(), options);
+            }), file_bytes);
+
+            BMPFile loaded;
+            report("load", "unpacked", name, size, 0, best([&] {
+                loaded.load(path.string(), BMPFile::Storage::Unpacked);
+            }), file_bytes);
+            report("load", "native", name, size, 0, best([&] {
+                loaded.load(path.string(), BMPFile::Storage::Native);
+            }), file_bytes);
+            report("load", "mmap", name, size, 0, best([&] {
+                loaded.mapFile(path.string(), BMPFile::MapMode::ReadOnly);
+            }), file_bytes);
+
+            // Thresholding is idempotent, so repeated runs do the same work
+            report("threshold", "unpacked", name, size, 0, best([&] {
+                image.convertToBlackAndWhite();
+            }), pixel_bytes);
+
+            BMPFile native;
+            native.load(path.string(), BMPFile::Storage::Native);
+            report("threshold", "native", name, size, 0, best([&] {
+                native.convertToBlackAndWhite();
+            }), file_bytes);
+        }
+    }
+
+    fs::remove(path);
+    return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file AsyncFileWriter.hpp
+ * @brief Sequential file writer with background I/O on aligned buffers
+ */
+
+#pragma once
+
+#include "BufferPool.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class AsyncFileWriter
+ * @brief Writes a file sequentially while the caller fills the next buffer
+ *
+ * The caller fills one aligned buffer while a background thread writes
+ * the previous ones, so encoding overlaps with write latency. With more
+ * than two buffers, several writes may be in flight at once. Optionally
+ * the file is opened with O_DIRECT, which bypasses the page cache, and
+ * preallocated with posix_fallocate.
+ */
+class AsyncFileWriter {
+public:
+    /**
+     * @struct Options
+     * @brief Buffering and I/O settings
+     */
+    struct Options {
+        size_t buffer_bytes = 4 << 20;  ///< Size of each buffer (rounded up, at least two blocks)
+        unsigned buffers = 2;           ///< Number of buffers (at least two)
+        bool direct = false;            ///< Bypass the page cache with O_DIRECT if supported
+        bool preallocate = false;       ///< Reserve the expected size with posix_fallocate
+    };
+
+    /// Alignment of buffers, file offsets and O_DIRECT transfer sizes
+    static constexpr size_t kAlignment = 4096;
+
+    AsyncFileWriter() = default;
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    /**
+     * @brief Creates or truncates a file and starts the writer thread
+     * @param filename Path to the file
+     * @param options Buffering and I/O settings
+     * @param expected_size Final file size if known (used for preallocation)
+     * @return true if the file was opened, false on error
+     */
+    bool open(const std::string& filename, const Options& options, uint64_t expected_size = 0);
+
+    /**
+     * @brief Gets largest block reserve() can return
+     * @return Buffer size, less one block in O_DIRECT mode
+     */
+    size_t bufferBytes() const { return direct_ ? buffer_bytes_ - kAlignment : buffer_bytes_; }
+
+    /**
+     * @brief Gets free space left in the current buffer
+     * @return Bytes that reserve() can return without switching buffers
+     */
+    size_t available() const { return current_ ? buffer_bytes_ - current_->used : buffer_bytes_; }
+
+    /**
+     * @brief Gets a contiguous block to fill in place
+     * @param bytes Block size, at most bufferBytes()
+     * @return Pointer to the block, valid until commit()
+     *
+     * Hands the current buffer to the writer first if the block does not
+     * fit, and waits if all buffers are still being written. In O_DIRECT
+     * mode the unaligned tail of that buffer moves to the next one, so
+     * every write starts on a block boundary.
+     */
+    uint8_t* reserve(size_t bytes);
+
+    /**
+     * @brief Appends a block previously obtained from reserve()
+     * @param bytes Number of bytes filled
+     */
+    void commit(size_t bytes);
+
+    /**
+     * @brief Appends bytes, copying them through the buffers
+     * @param data Source bytes
+     * @param bytes Number of bytes
+     */
+    void write(const void* data, size_t bytes);
+
+    /**
+     * @brief Writes everything still buffered and closes the file
+     * @return true if every write succeeded, false on any I/O error
+     */
+    bool close();
+
+private:
+    /// Returns a buffer to BufferPool::shared()
+    struct PoolDeleter {
+        size_t bytes;  ///< Size the buffer was acquired with
+        void operator()(uint8_t* p) const { BufferPool::shared().release(p, bytes); }
+    };
+
+    /**
+     * @struct Buffer
+     * @brief One aligned buffer and the file range it holds
+     */
+    struct Buffer {
+        std::unique_ptr<uint8_t, PoolDeleter> data;  ///< Aligned storage
+        size_t used = 0;                             ///< Bytes filled
+        uint64_t offset = 0;                         ///< File offset of the first byte
+    };
+
+    std::vector<Buffer> storage_;     ///< All buffers
+    std::deque<Buffer*> free_;        ///< Buffers ready to be filled
+    std::deque<Buffer*> full_;        ///< Buffers waiting to be written
+    Buffer* current_ = nullptr;       ///< Buffer being filled by the caller
+    size_t buffer_bytes_ = 0;         ///< Size of each buffer
+    uint64_t offset_ = 0;             ///< File offset of the next buffer
+    int fd_ = -1;                     ///< File descriptor
+    bool direct_ = false;             ///< File was opened with O_DIRECT
+    bool failed_ = false;             ///< A write failed
+    bool stop_ = false;               ///< No more buffers will be queued
+
+    std::mutex mutex_;                ///< Guards the queues and flags
+    std::condition_variable changed_; ///< Signals queue changes
+    std::thread thread_;              ///< Background writer
+
+    void submit(bool final);
+    Buffer* acquire();
+    void writerLoop();
+    bool writeBuffer(const Buffer& buffer);
+};
@@ -0,0 +1,147 @@
+/**
+ * @file BMPDecoder.hpp
+ * @brief Expansion of palettized, bitfield and RLE-compressed BMP pixel data
+ */
+
+#pragma once
+
+#include "BMPFile.hpp"
+#include <array>
+#include <cstdint>
+#include <istream>
+
+/**
+ * @class BMPDecoder
+ * @brief Converts BMP pixel data that is not stored as BGR24/BGRA32
+ *
+ * Handles 1/4/8-bit color tables, RLE8 and RLE4 compression and 16/32-bit
+ * BI_BITFIELDS masks. Uncompressed rows are expanded with lookup tables
+ * built once per file: a table entry covers a whole byte of 1 and 4-bit
+ * indices and a whole 16-bit pixel. RLE data is decoded in one streaming
+ * pass straight into the destination rows. 16-bit and indexed images
+ * decode to BGR24, 32-bit bitfield images to BGRA32.
+ */
+class BMPDecoder {
+public:
+    /// Values of DIBHeader::compression
+    enum Compression : uint32_t {
+        kRgb = 0,             ///< Uncompressed
+        kRle8 = 1,            ///< 8-bit run-length encoding
+        kRle4 = 2,            ///< 4-bit run-length encoding
+        kBitfields = 3,       ///< Red, green and blue masks after the header
+        kAlphaBitfields = 6   ///< Red, green, blue and alpha masks after the header
+    };
+
+    /**
+     * @brief Checks if rows can be used as stored, without a decoder
+     * @param dib_header Information header
+     * @return true for uncompressed 24 and 32-bit images
+     */
+    static bool isNative(const BMPFile::DIBHeader& dib_header) {
+        return dib_header.compression == kRgb &&
+               (dib_header.bits_per_pixel == 24 || dib_header.bits_per_pixel == 32);
+    }
+
+    /**
+     * @brief Reads the color table or masks and prepares the lookup tables
+     * @param file Stream holding the whole file
+     * @param bmp_header File header
+     * @param dib_header Information header
+     * @throw std::runtime_error on unsupported or malformed headers
+     */
+    BMPDecoder(std::istream& file, const BMPFile::BMPHeader& bmp_header, const BMPFile::DIBHeader& dib_header);
+
+    /**
+     * @brief Gets pixel format of the decoded image
+     * @return BGRA32 for 32-bit sources, BGR24 otherwise
+     */
+    BMPFile::PixelFormat format() const { return format_; }
+
+    /**
+     * @brief Checks if pixel data is run-length encoded
+     * @return true for RLE8 and RLE4
+     */
+    bool isRle() const { return rle_; }
+
+    /**
+     * @brief Gets stored size of an uncompressed row
+     * @return Row size in bytes including padding
+     */
+    size_t storedRowSize() const { return stored_row_size_; }
+
+    /**
+     * @brief Expands one uncompressed stored row
+     * @param src First byte of the row
+     * @param dst Destination pixels (count elements)
+     * @param count Number of pixels
+     */
+    void decodeRow(const uint8_t* src, BMPFile::Pixel* dst, int count) const { decode_row_(*this, src, dst, count); }
+
+    /**
+     * @brief Decodes run-length encoded pixel data into rows
+     * @param file Stream positioned at the pixel data
+     * @param layout Destination rows of the decoded format, or of BGRA32 Pixels
+     * @return Number of compressed bytes consumed
+     * @throw std::runtime_error on truncated data
+     *
+     * Pixels the data skips with delta or end-of-line codes get color 0,
+     * and runs that pass the edge of the image are clipped.
+     */
+    uint64_t decodeRle(std::istream& file, const BMPFile::RowLayout& layout) const;
+
+private:
+    /// Row expansion for one source format
+    using DecodeRowFn = void (*)(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count);
+
+    /**
+     * @struct Channel
+     * @brief One color mask of a bitfield image
+     */
+    struct Channel {
+        uint32_t mask = 0;                 ///< Mask within the stored pixel
+        int shift = 0;                     ///< Position of the lowest mask bit
+        int drop = 0;                      ///< Low bits dropped to fit a byte
+        std::array<uint8_t, 256> scale{};  ///< Reduced channel value to 0..255
+    };
+
+    /**
+     * @brief Validates a mask and builds its scale table
+     * @param mask Channel mask, 0 for an absent channel
+     * @return Prepared channel
+     * @throw std::runtime_error if the mask bits are not contiguous
+     */
+    static Channel makeChannel(uint32_t mask);
+
+    /**
+     * @brief Expands one stored pixel through the channel masks
+     * @param value Stored pixel
+     * @return Decoded pixel, opaque if there is no alpha mask
+     */
+    BMPFile::Pixel unpackBitfields(uint32_t value) const;
+
+    static void decodeIndexed1(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count);
+    static void decodeIndexed4(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count);
+    static void decodeIndexed8(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count);
+    static void decodeBitfields16(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count);
+    static void decodeBitfields32(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count);
+
+    /**
+     * @brief Decodes RLE data for one destination layout and index width
+     * @tparam Format Destination pixel layout
+     * @tparam Bits Bits per index (8 or 4)
+     */
+    template <BMPFile::PixelFormat Format, int Bits>
+    uint64_t decodeRleRows(std::istream& file, const BMPFile::RowLayout& layout) const;
+
+    int width_;                                 ///< Image width
+    int height_;                                ///< Image height
+    int bits_;                                  ///< Stored bits per pixel
+    bool rle_ = false;                          ///< Pixel data is run-length encoded
+    uint32_t rle_size_ = 0;                     ///< Compressed size from the header, 0 if unknown
+    size_t stored_row_size_ = 0;                ///< Uncompressed row size with padding
+    BMPFile::PixelFormat format_ = BMPFile::PixelFormat::BGR24; ///< Decoded format
+    DecodeRowFn decode_row_ = nullptr;          ///< Row expansion for the source format
+    std::array<BMPFile::Pixel, 256> palette_{}; ///< Color table, black past its end
+    PooledVector<BMPFile::Pixel> table_;        ///< Pixels per index byte or per 16-bit value
+    std::array<Channel, 4> channels_;           ///< Blue, green, red and alpha masks
+};
@@ -6,9 +6,18 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 #include <string>
+#include <cstddef>
 #include <cstdint>
 #include <fstream>
+#include <stdexcept>
+#include "MappedFile.hpp"
+#include "AsyncFileWriter.hpp"
+#include "BufferPool.hpp"
+
+class ThresholdKernel;
+class BinaryRaster;
 
 /**
  * @class BMPFile
@@ -29,6 +38,30 @@ public:
         BGRA32  ///< 32-bit format (blue, green, red, alpha channel)
     };
 
+    /**
+     * @enum Storage
+     * @brief How pixel data is kept in memory
+     */
+    enum class Storage {
+        Unpacked,  ///< One 4-byte Pixel per pixel, top-down
+        Native     ///< Rows in on-disk layout and order, including padding
+    };
+
+    /// Access mode for memory-mapped images
+    using MapMode = MappedFile::Mode;
+
+    /**
+     * @struct MipOutput
+     * @brief Pyramid level written next to the full-size image
+     */
+    struct MipOutput {
+        int level = 1;         ///< Level number (1 = half size, 2 = quarter size, ...)
+        std::string filename;  ///< Path of the level's BMP file
+    };
+
+    /// Pyramid levels, level k at index k - 1
+    using Pyramid = std::vector<std::unique_ptr<BMPFile>>;
+
     #pragma pack(push, 1)
     /**
      * @struct BMPHeader
@@ -93,22 +126,200 @@ public:
         }
     };
 
+    /**
+     * @struct Pixel24
+     * @brief On-disk pixel of a BGR24 image
+     */
+    struct Pixel24 {
+        uint8_t b = 0;  ///< Blue component
+        uint8_t g = 0;  ///< Green component
+        uint8_t r = 0;  ///< Red component
+    };
+
+    static_assert(sizeof(Pixel) == 4, "Pixel must match the BGRA32 on-disk layout");
+    static_assert(sizeof(Pixel24) == 3, "Pixel24 must match the BGR24 on-disk layout");
+
+    /**
+     * @class RowView
+     * @brief Typed view over one row of natively stored pixels
+     * @tparam T Pixel24 for BGR24 images, Pixel for BGRA32 images
+     */
+    template <typename T>
+    class RowView {
+    public:
+        RowView(T* data, int width) : data_(data), width_(width) {}
+
+        T& operator[](int x) const { return data_[x]; }
+        T* begin() const { return data_; }
+        T* end() const { return data_ + width_; }
+        T* data() const { return data_; }
+        int size() const { return width_; }
+
+    private:
+        T* data_;    ///< First pixel of the row
+        int width_;  ///< Number of pixels in the row
+    };
+
     BMPFile() = default;
     ~BMPFile() = default;
 
+    /**
+     * @brief Moves an image, taking over its buffers or mapping
+     * @param other Image to move from; left as an empty 0x0 image
+     */
+    BMPFile(BMPFile&& other) noexcept;
+    BMPFile& operator=(BMPFile&& other) noexcept;
+
     /**
      * @brief Loads BMP image from file
      * @param filename Path to the file
-     * @return true if loading succeeded, false on error
+     * @param storage Unpacked pixels, or Native to read the pixel block with a single copy
+     * @return true if loading succeeded, false on error (the image is then empty)
+     *
+     * 1/4/8-bit palettized, RLE8/RLE4 and 16/32-bit bitfield files are
+     * decoded on the fly (see BMPDecoder) and then behave like the 24 or
+     * 32-bit file they expand to.
      */
-    bool load(const std::string& filename);
+    bool load(const std::string& filename, Storage storage = Storage::Unpacked);
     
     /**
      * @brief Saves BMP image to file
      * @param filename Path to the file
+     * @param mips Pyramid levels to write as separate files
+     * @return true if saving succeeded, false on error
+     * @throw std::invalid_argument if a mip level is out of range
+     *
+     * Pyramid rows are built while the rows under them are still in cache
+     * from encoding, then each requested level is saved.
+     */
+    bool save(const std::string& filename, const std::vector<MipOutput>& mips = {}) const;
+
+    /**
+     * @brief Saves BMP image, writing in the background while rows are encoded
+     * @param filename Path to the file
+     * @param options Buffering and I/O settings of the writer
+     * @param mips Pyramid levels to write as separate files
+     * @return true if saving succeeded, false on error
+     * @throw std::invalid_argument if a mip level is out of range
+     *
+     * Produces the same files as save(). Rows are encoded straight into the
+     * writer's aligned buffers while earlier buffers are being written.
+     */
+    bool saveAsync(const std::string& filename, const AsyncFileWriter::Options& options,
+                   const std::vector<MipOutput>& mips = {}) const;
+
+    /**
+     * @brief Saves a black and white image as a 1-bit palettized BMP
+     * @param filename Path to the file
+     * @param mips Pyramid levels to write as separate (full color) files
      * @return true if saving succeeded, false on error
+     * @throw std::invalid_argument if a mip level is out of range
+     *
+     * Meant for images after convertToBlackAndWhite(): each pixel becomes
+     * one bit of a black/white color table, packed eight to a byte by the
+     * fastest BitPackKernel (see there for the white test). Orientation is
+     * kept; the file is 24 or 32 times smaller than with save().
      */
-    bool save(const std::string& filename) const;
+    bool saveMonochrome(const std::string& filename, const std::vector<MipOutput>& mips = {}) const;
+
+    /**
+     * @brief Builds a mip pyramid of the image
+     * @param levels Number of levels below the full image
+     * @return Unpacked images, each half the size of the previous one
+     * @throw std::invalid_argument if levels exceeds maxPyramidLevels()
+     *
+     * Every level is 2x2 box filtered from the one above it; groups of
+     * source rows are filtered in parallel on large images.
+     */
+    Pyramid buildPyramid(int levels) const;
+
+    /**
+     * @brief Gets the deepest pyramid level that still has whole pixels
+     * @return floor(log2(min(width, height))), 0 for an empty image
+     */
+    int maxPyramidLevels() const;
+
+    /**
+     * @brief Maps BMP image from file without copying pixel data
+     * @param filename Path to the file
+     * @param mode ReadOnly, or CopyOnWrite to allow drawing on a private copy of the pages
+     * @return true if mapping succeeded, false on error (the image is then empty)
+     *
+     * Headers are validated in place and pixel rows stay in the mapping with
+     * Native storage; pages are only read when first touched. Files that
+     * need decoding are loaded into Native storage instead.
+     */
+    bool mapFile(const std::string& filename, MapMode mode = MapMode::CopyOnWrite);
+
+    /**
+     * @brief Checks if pixel data lives in a file mapping
+     * @return true if image was opened with mapFile, false otherwise
+     */
+    bool isMapped() const { return mapping_.isOpen(); }
+
+    /**
+     * @brief Gets current pixel storage
+     * @return Unpacked or Native
+     */
+    Storage storage() const { return storage_; }
+
+    /**
+     * @brief Gets pixel format of the image
+     * @return BGR24 or BGRA32
+     */
+    PixelFormat format() const { return is32bit() ? PixelFormat::BGRA32 : PixelFormat::BGR24; }
+
+    /**
+     * @brief Gets raw on-disk bytes of a natively stored row
+     * @param y Y coordinate (0..height-1), not bounds-checked
+     * @return Pointer to the first byte of the row (BGR or BGRA, unpadded part)
+     * @throw std::logic_error if storage is not Native or is mapped read-only (non-const overload)
+     */
+    uint8_t* rowData(int y);
+    const uint8_t* rowData(int y) const;
+
+    /**
+     * @struct RowLayout
+     * @brief Address arithmetic for the writable rows of an image
+     */
+    struct RowLayout {
+        uint8_t* origin = nullptr;                 ///< First byte of row 0
+        ptrdiff_t stride = 0;                      ///< Bytes from row y to row y + 1 (negative for bottom-up files)
+        PixelFormat format = PixelFormat::BGRA32;  ///< Stored pixel layout (always BGRA32 when Unpacked)
+
+        /**
+         * @brief Gets the first byte of a row
+         * @param y Y coordinate (0..height-1), not bounds-checked
+         * @return Row address
+         */
+        uint8_t* row(int y) const { return origin + y * stride; }
+    };
+
+    /**
+     * @brief Gets row addressing that works for every storage
+     * @return Origin, stride and pixel layout of the stored rows
+     * @throw std::logic_error if the image is mapped read-only
+     */
+    RowLayout rowLayout();
+
+    /**
+     * @brief Gets typed view of a natively stored row
+     * @tparam T Pixel24 for BGR24 images, Pixel for BGRA32 images
+     * @param y Y coordinate (0..height-1), not bounds-checked
+     * @return View over the row's pixels
+     * @throw std::logic_error if T does not match the pixel format
+     */
+    template <typename T>
+    RowView<T> rowView(int y) {
+        checkViewType(sizeof(T));
+        return {reinterpret_cast<T*>(rowData(y)), width()};
+    }
+
+    template <typename T>
+    RowView<const T> rowView(int y) const {
+        checkViewType(sizeof(T));
+        return {reinterpret_cast<const T*>(rowData(y)), width()};
+    }
 
     /**
      * @brief Gets image width
@@ -146,6 +357,53 @@ public:
      */
     void setPixel(int x, int y, Pixel pixel);
     
+    /**
+     * @brief Gets unchecked pointer to an unpacked row
+     * @param y Y coordinate (0..height-1), not bounds-checked
+     * @return First pixel of the row
+     * @throw std::logic_error if storage is not Unpacked
+     */
+    Pixel* row(int y);
+    const Pixel* row(int y) const;
+
+    /**
+     * @brief Fills pixels [x0, x1] of a row with a color
+     * @param y Y coordinate, must be within the image
+     * @param x0 First X coordinate, must be within the image
+     * @param x1 Last X coordinate (inclusive), must be within the image
+     * @param color Fill color
+     *
+     * Coordinates are not checked: callers clip first. Works for every
+     * storage; the image must not be mapped read-only. Paints through the
+     * same SpanPainter the strategies use, so callers painting many spans
+     * should take a painter from withSpanPainter() once instead.
+     */
+    void fillSpan(int y, int x0, int x1, Pixel color);
+
+    /**
+     * @brief Composites a color over pixels [x0, x1] of a row (source-over)
+     * @param y Y coordinate, must be within the image
+     * @param x0 First X coordinate, must be within the image
+     * @param x1 Last X coordinate (inclusive), must be within the image
+     * @param color Color with straight alpha; opaque colors are filled
+     *
+     * Same preconditions as fillSpan. Uses the fastest BlendKernel for the
+     * running CPU on every storage and pixel format.
+     */
+    void blendSpan(int y, int x0, int x1, Pixel color);
+
+    /**
+     * @brief Fills the rectangle [x0, x1] x [y0, y1] with a color
+     * @param x0 Left X coordinate, must be within the image
+     * @param y0 Top Y coordinate, must be within the image
+     * @param x1 Right X coordinate (inclusive), must be within the image
+     * @param y1 Bottom Y coordinate (inclusive), must be within the image
+     * @param color Fill color
+     *
+     * Same preconditions as fillSpan.
+     */
+    void fillRect(int x0, int y0, int x1, int y1, Pixel color);
+    
     /**
      * @brief Flips image vertically
      */
@@ -153,18 +411,111 @@ public:
     
     /**
      * @brief Converts image to black and white
+     *
+     * Uses the fastest threshold kernel for the running CPU and splits
+     * large images into row bands processed in parallel.
      */
     void convertToBlackAndWhite();
 
+    /**
+     * @brief Converts image to black and white with a specific kernel
+     * @param kernel Threshold kernel (see ThresholdKernel::forIsa)
+     * @throw std::logic_error if the image is mapped read-only
+     */
+    void convertToBlackAndWhite(const ThresholdKernel& kernel);
+
+    /**
+     * @brief Thresholds the image into a bit-packed raster
+     * @param out Raster resized to the image and filled; it keeps the
+     *            image orientation for saving
+     *
+     * The image itself is left unchanged. Rows are thresholded into a
+     * small scratch buffer and packed straight into out, so the result
+     * takes one bit per pixel instead of a full thresholded copy.
+     */
+    void convertToBlackAndWhite(BinaryRaster& out) const;
+
+    /**
+     * @brief Converts a range of rows to black and white on the calling thread
+     * @param first_row First row to convert
+     * @param rows Number of rows
+     * @throw std::out_of_range if the range exceeds the image
+     */
+    void convertRowsToBlackAndWhite(int first_row, int rows);
+
+    /**
+     * @brief Converts one row to its on-disk layout
+     * @param y Y coordinate (0..height-1)
+     * @param dst Destination of at least one padded row; padding is only written for Native storage
+     * @throw std::out_of_range if y is out of bounds
+     */
+    void encodeRow(int y, uint8_t* dst) const;
+
+    /**
+     * @brief Gets BMP file header
+     * @return File header
+     */
+    const BMPHeader& bmpHeader() const { return bmp_header_; }
+
+    /**
+     * @brief Gets BMP information header
+     * @return Information header (orientation is the sign of height)
+     */
+    const DIBHeader& dibHeader() const { return dib_header_; }
+
+    /**
+     * @brief Checks that headers describe a BMP with uncompressed 24/32-bit rows
+     * @param bmp_header File header
+     * @param dib_header Information header
+     * @throw std::runtime_error on unsupported or malformed headers
+     */
+    static void validateHeaders(const BMPHeader& bmp_header, const DIBHeader& dib_header);
+
+    /**
+     * @brief Calculates on-disk row size with padding
+     * @param width Image width in pixels
+     * @param format Pixel format
+     * @return Row size in bytes
+     */
+    static size_t rowSize(int width, PixelFormat format) {
+        const size_t bytes_per_pixel = format == PixelFormat::BGRA32 ? 4 : 3;
+        return (width * bytes_per_pixel + 3) & ~size_t(3);
+    }
+
+    /// Color table of 1-bit files: index 0 black, index 1 white (B, G, R, reserved)
+    static constexpr uint8_t kMonoPalette[8] = {0, 0, 0, 0, 255, 255, 255, 0};
+
+    /**
+     * @brief Builds the headers of a 1-bit black and white file
+     * @param width Image width in pixels
+     * @param height Image height in pixels, negative for top-down rows
+     * @param bmp_header Receives the file header
+     * @param dib_header Receives the information header
+     *
+     * The pixel data starts right after the headers and kMonoPalette.
+     */
+    static void monochromeHeaders(int width, int32_t height, BMPHeader& bmp_header, DIBHeader& dib_header);
+
+    /**
+     * @brief Calculates 1-bit row size with padding
+     * @param width Image width in pixels
+     * @return Row size in bytes
+     */
+    static size_t monochromeRowSize(int width) { return (static_cast<size_t>(width) + 31) / 32 * 4; }
+
     /**
      * @brief Creates a new blank BMP image
      */
-    void create(int width, int height, PixelFormat format, Pixel fill_color);
+    void create(int width, int height, PixelFormat format, Pixel fill_color,
+                Storage storage = Storage::Unpacked);
 
 private:
     BMPHeader bmp_header_;          ///< BMP file header
     DIBHeader dib_header_;          ///< Information header
-    std::vector<Pixel> pixels_;     ///< Image pixel array
+    PooledVector<Pixel> pixels_;    ///< Image pixel array (Unpacked storage)
+    PooledVector<uint8_t> packed_;  ///< On-disk pixel block (Native storage, not mapped)
+    MappedFile mapping_;            ///< File mapping holding pixels when mapped
+    Storage storage_ = Storage::Unpacked; ///< Current pixel storage
 
     /**
      * @brief Reads headers from file
@@ -177,6 +528,96 @@ private:
      * @param file File stream
      */
     void readPixels(std::ifstream& file);
+
+    /**
+     * @brief Reads pixel block from file into native storage
+     * @param file File stream
+     */
+    void readPackedPixels(std::ifstream& file);
+
+    /**
+     * @brief Decodes palettized, bitfield or RLE pixel data into storage
+     * @param file File stream
+     * @param storage Pixel storage to decode into
+     * @return Bytes of the file consumed
+     * @throw std::runtime_error on unsupported, malformed or truncated data
+     *
+     * Headers are rewritten to describe the decoded BGR24/BGRA32 image.
+     */
+    uint64_t readDecodedPixels(std::ifstream& file, Storage storage);
+
+    /**
+     * @brief Thresholds rows [first_row, end_row)
+     * @param kernel Threshold kernel
+     * @param first_row First row
+     * @param end_row Row after the last one
+     * @param parallel Split rows across threads
+     */
+    void thresholdRows(const ThresholdKernel& kernel, int first_row, int end_row, bool parallel);
+
+    /**
+     * @brief Makes the image an empty 0x0 image
+     */
+    void reset();
+
+    /**
+     * @brief Releases all pixel storage
+     */
+    void releasePixels();
+
+    /**
+     * @brief Allocates blank pyramid levels in the image's format
+     * @param levels Number of levels
+     * @return Levels, each half the size of the previous one
+     * @throw std::invalid_argument if levels exceeds maxPyramidLevels()
+     */
+    Pyramid createPyramid(int levels) const;
+
+    /**
+     * @brief Fills pyramid rows under groups of source rows
+     * @param pyramid Pyramid levels
+     * @param first_group First group of 2^levels logical source rows
+     * @param end_group Group after the last one; the final group may end early
+     * @param parallel Split groups across threads
+     */
+    void downsampleGroups(const Pyramid& pyramid, int first_group, int end_group, bool parallel) const;
+
+    /**
+     * @brief Fills pyramid rows completed by encoding file rows [done_rows, end_row)
+     * @param pyramid Pyramid levels
+     * @param done_rows File rows encoded before
+     * @param end_row File rows encoded now
+     * @param parallel Split groups across threads
+     *
+     * File rows run bottom-up for bottom-up images, so the finished groups
+     * may grow from either end of the image.
+     */
+    void downsampleFileRows(const Pyramid& pyramid, int done_rows, int end_row, bool parallel) const;
+
+    /**
+     * @brief Saves requested pyramid levels
+     * @param pyramid Pyramid levels
+     * @param mips Levels to write
+     * @return true if every level was saved
+     */
+    static bool saveMips(const Pyramid& pyramid, const std::vector<MipOutput>& mips);
+
+    /**
+     * @brief Gets start of the native pixel block (first row in file order)
+     * @return Pointer into the mapping or the owned packed buffer
+     */
+    uint8_t* nativeBase();
+    const uint8_t* nativeBase() const;
+
+    /**
+     * @brief Checks that a typed row view matches the image layout
+     * @param pixel_size Size of the view's pixel type
+     * @throw std::logic_error on mismatch
+     */
+    void checkViewType(size_t pixel_size) const {
+        if (storage_ != Storage::Native || pixel_size != bytesPerPixel())
+            throw std::logic_error("Row view type does not match pixel layout");
+    }
     
     /**
      * @brief Writes headers to file
@@ -189,6 +630,12 @@ private:
      * @return Row size in bytes
      */
     size_t getRowSize() const;
+
+    /**
+     * @brief Gets number of bytes per pixel in the on-disk layout
+     * @return 3 for 24-bit, 4 for 32-bit images
+     */
+    size_t bytesPerPixel() const { return is32bit() ? 4 : 3; }
     
     /**
      * @brief Calculates index in pixel array
@@ -1,5 +1,7 @@
 #pragma once
 #include "BMPFile.hpp"
+#include "BinaryRaster.hpp"
+#include "BMPStream.hpp"
 #include "DrawStrategyFactory.hpp"
 #include <memory>
 
@@ -20,10 +22,62 @@ public:
         std::string input_file;                            ///< Input BMP file path
         std::string output_file = "output.bmp";            ///< Output BMP file path
         std::pair<char, char> display_chars = {'#', ' '};  ///< Characters for console display (foreground, background)
+        int preview_width = 0;                             ///< Console preview width limit (0 = image width; parse() defaults to the terminal)
+        int preview_height = 0;                            ///< Console preview height limit (0 = image height; parse() defaults to the terminal)
         BMPFile::Pixel color = {0, 0, 0, 255};             ///< Drawing color (RGBA, default: opaque black)
         unsigned int thickness = 1;                        ///< Line thickness in pixels
         std::string strategy_name = "none";                ///< Drawing strategy name
         DrawStrategyFactory::StrategyType strategy_type = DrawStrategyFactory::StrategyType::NONE;  ///< Drawing strategy type
+        bool use_mmap = false;                             ///< Map input file copy-on-write instead of reading it
+        BMPFile::Storage storage = BMPFile::Storage::Unpacked; ///< Pixel storage used when reading the input
+        unsigned int band_rows = 0;                        ///< Rows per band when streaming (0 = load whole image)
+        bool fused = false;                                ///< Draw, threshold and encode tile by tile in one pass
+        std::string manifest_file;                         ///< Batch manifest with one job per line
+        std::string input_dir;                             ///< Batch directory whose .bmp files are processed
+        std::string output_pattern = "{name}_out.bmp";     ///< Batch output path with {name} and {index} placeholders
+        unsigned int workers = 1;                          ///< Batch draw/threshold worker threads
+        unsigned int queue_depth = 2;                      ///< Batch images queued between pipeline stages
+        bool async_save = false;                           ///< Encode rows while a background thread writes
+        bool direct_io = false;                            ///< Save with O_DIRECT and preallocation (implies async_save)
+        std::string stats_file;                            ///< JSON stats output ("-" = stdout, empty = off)
+        std::vector<int> mip_levels;                       ///< Pyramid levels saved next to each output
+        std::string shapes_file;                           ///< Display list drawn instead of the cross
+        std::shared_ptr<const DisplayList> shapes;         ///< Display list loaded from shapes_file
+        bool mono = false;                                 ///< Save 1-bit black and white output
+
+        /**
+         * @brief Check if the configuration describes a batch run
+         * @return true if a manifest or input directory is set
+         */
+        bool isBatch() const { return !manifest_file.empty() || !input_dir.empty(); }
+
+        /**
+         * @brief Check if thresholded images are kept as bit-packed rasters
+         * @return true for 1-bit output without pyramid levels, which need full pixels
+         */
+        bool binaryOutput() const { return mono && mip_levels.empty(); }
+
+        /**
+         * @brief Save an image the way the configuration asks for
+         * @param image Image to save
+         * @param filename Output file path
+         * @return true if saving succeeded, false on error
+         */
+        bool save(const BMPFile& image, const std::string& filename) const;
+
+        /**
+         * @brief Save a bit-packed raster as a 1-bit BMP
+         * @param raster Thresholded raster
+         * @param filename Output file path
+         * @return true if saving succeeded, false on error
+         */
+        bool save(const BinaryRaster& raster, const std::string& filename) const;
+
+        /**
+         * @brief Create the drawing strategy the configuration asks for
+         * @return Display list strategy if shapes were loaded, cross strategy otherwise
+         */
+        std::unique_ptr<IDrawStrategy> createStrategy() const;
 
         /**
          * @brief Parse command line arguments into Config
@@ -60,7 +114,22 @@ public:
     void display() const;
     
 private:
+    /**
+     * @brief Stream the image through draw, threshold and save band by band
+     * @throws std::runtime_error on I/O errors
+     *
+     * Peak memory is one band of config_.band_rows rows.
+     */
+    void processBands();
+
+    /**
+     * @brief Draw, threshold and save the loaded image one cache-sized tile of rows at a time
+     * @throws std::runtime_error on I/O errors
+     */
+    void processFused();
+
     Config config_;                                 ///< Processing configuration
     BMPFile bmp_;                                   ///< BMP image handler
+    BinaryRaster binary_;                           ///< Thresholded image when config_.binaryOutput()
     std::unique_ptr<IDrawStrategy> draw_strategy_;  ///< Drawing strategy implementation
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+/**
+ * @file BMPStream.hpp
+ * @brief Band-wise BMP reading and writing for images larger than memory
+ */
+
+#pragma once
+
+#include "BMPFile.hpp"
+#include <fstream>
+#include <string>
+
+/**
+ * @class BMPStreamReader
+ * @brief Reads a BMP file in horizontal bands of rows
+ *
+ * Only the headers are kept in memory; every band is read straight into
+ * the native rows of a band image.
+ */
+class BMPStreamReader {
+public:
+    /**
+     * @brief Opens a BMP file and reads its headers
+     * @param filename Path to the file
+     * @return true if the file is a supported BMP, false on error
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Reads consecutive rows into a band image
+     * @param band Image that receives the rows (re-created with Native storage if its shape differs)
+     * @param first_row First row to read (0 = top of the image)
+     * @param rows Number of rows to read
+     * @return true if rows were read, false on error or invalid range
+     */
+    bool readBand(BMPFile& band, int first_row, int rows);
+
+    int width() const { return dib_header_.width; }
+    int height() const { return std::abs(dib_header_.height); }
+    BMPFile::PixelFormat format() const {
+        return dib_header_.bits_per_pixel == 32 ? BMPFile::PixelFormat::BGRA32 : BMPFile::PixelFormat::BGR24;
+    }
+    const BMPFile::BMPHeader& bmpHeader() const { return bmp_header_; }
+    const BMPFile::DIBHeader& dibHeader() const { return dib_header_; }
+
+private:
+    std::ifstream file_;               ///< Input stream
+    BMPFile::BMPHeader bmp_header_;    ///< File header
+    BMPFile::DIBHeader dib_header_;    ///< Information header
+    size_t row_size_ = 0;              ///< Padded row size in bytes
+};
+
+/**
+ * @class BMPStreamWriter
+ * @brief Writes a BMP file band by band, in any order
+ */
+class BMPStreamWriter {
+public:
+    /**
+     * @brief Creates the output file and writes its headers
+     * @param filename Path to the file
+     * @param bmp_header File header of the output
+     * @param dib_header Information header of the output (defines size, format and orientation)
+     * @return true on success, false on error
+     */
+    bool open(const std::string& filename, const BMPFile::BMPHeader& bmp_header,
+              const BMPFile::DIBHeader& dib_header);
+
+    /**
+     * @brief Writes a band of rows at its place in the output
+     * @param band Natively stored band with the output's width and format
+     * @param first_row Output row of the band's first row (0 = top of the image)
+     * @return true on success, false on error or invalid range
+     */
+    bool writeBand(const BMPFile& band, int first_row);
+
+    /**
+     * @brief Flushes and closes the output
+     * @return true if all data was written, false on error
+     */
+    bool close();
+
+private:
+    std::ofstream file_;               ///< Output stream
+    BMPFile::DIBHeader dib_header_;    ///< Information header of the output
+    BMPFile::PixelFormat format_ = BMPFile::PixelFormat::BGR24; ///< Pixel format of the output
+    size_t row_size_ = 0;              ///< Padded row size in bytes
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include "BMPProcessor.hpp"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class BatchProcessor
+ * @brief Runs the load, draw, threshold and save pipeline over many images
+ *
+ * A loader thread reads the next images while worker threads draw and
+ * threshold, and the calling thread saves finished images. Stages are
+ * connected by bounded queues, so only a few images are in memory at once.
+ */
+class BatchProcessor {
+public:
+    /**
+     * @struct Job
+     * @brief One input image and where its result goes
+     */
+    struct Job {
+        std::string input;   ///< Input BMP file path
+        std::string output;  ///< Output BMP file path
+    };
+
+    /**
+     * @brief Construct a new BatchProcessor object
+     * @param config Processing configuration with manifest or input directory
+     * @throws std::runtime_error if the job list cannot be read
+     */
+    explicit BatchProcessor(const BMPProcessor::Config& config);
+
+    /**
+     * @brief Collect jobs from a manifest file or an input directory
+     * @param config Processing configuration
+     * @return Jobs in processing order
+     * @throws std::runtime_error if the manifest or directory cannot be read
+     *
+     * Manifest lines hold an input path, optionally followed by whitespace
+     * and an output path. Empty lines and lines starting with '#' are
+     * skipped. Outputs not given explicitly come from the output pattern,
+     * where {name} is replaced by the input file name without extension
+     * and {index} by the job number.
+     */
+    static std::vector<Job> collectJobs(const BMPProcessor::Config& config);
+
+    /**
+     * @brief Process all jobs
+     * @return true if every image was processed and saved
+     */
+    bool run();
+
+    /**
+     * @brief Get number of jobs
+     * @return Job count
+     */
+    size_t jobs() const { return jobs_.size(); }
+
+    /**
+     * @brief Get number of images that failed
+     * @return Failure count of the last run
+     */
+    size_t failed() const { return failed_; }
+
+private:
+    /**
+     * @brief Report a failed job
+     * @param job Job that failed
+     * @param what Error description
+     */
+    void reportFailure(const Job& job, const std::string& what);
+
+    BMPProcessor::Config config_;       ///< Processing configuration
+    std::vector<Job> jobs_;             ///< Jobs in processing order
+    std::atomic<size_t> failed_{0};     ///< Number of failed jobs
+    std::mutex report_mutex_;           ///< Serializes error output
+};
@@ -0,0 +1,145 @@
+/**
+ * @file BinaryRaster.hpp
+ * @brief Bit-packed black and white image
+ */
+
+#pragma once
+
+#include "BufferPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class BinaryRaster
+ * @brief Black and white image holding one bit per pixel in 64-bit words
+ *
+ * Rows are padded to whole words and stored in 1bpp BMP byte order: the
+ * first pixel of a row is the most significant bit of its first byte,
+ * and a set bit means white. Bits past the width are kept clear. Span
+ * fills and pixel counts run on whole words, and saving writes the rows
+ * as they are. Produced by BMPFile::convertToBlackAndWhite(BinaryRaster&).
+ */
+class BinaryRaster {
+public:
+    BinaryRaster() = default;
+
+    /**
+     * @brief Creates a raster of one color
+     * @param width Width in pixels
+     * @param height Height in pixels
+     * @param white Initial color of every pixel
+     * @param top_down Save rows top to bottom (negative BMP height)
+     * @throw std::invalid_argument if a dimension is negative
+     *
+     * Reuses the current buffer when it is large enough.
+     */
+    void create(int width, int height, bool white = false, bool top_down = false);
+
+    /**
+     * @brief Gets raster width
+     * @return Width in pixels
+     */
+    int width() const { return width_; }
+
+    /**
+     * @brief Gets raster height
+     * @return Height in pixels
+     */
+    int height() const { return height_; }
+
+    /**
+     * @brief Checks row order used when saving
+     * @return true if rows are saved top to bottom
+     */
+    bool topDown() const { return top_down_; }
+
+    /**
+     * @brief Gets number of words in a row
+     * @return Words per row, padding included
+     */
+    size_t wordsPerRow() const { return words_per_row_; }
+
+    /**
+     * @brief Gets unchecked pointer to a row
+     * @param y Y coordinate (0..height-1), not bounds-checked
+     * @return First word of the row
+     */
+    uint64_t* row(int y) { return words_.data() + y * words_per_row_; }
+    const uint64_t* row(int y) const { return words_.data() + y * words_per_row_; }
+
+    /**
+     * @brief Gets pixel by coordinates
+     * @param x X coordinate (0..width-1)
+     * @param y Y coordinate (0..height-1)
+     * @return true for white
+     * @throw std::out_of_range if coordinates are out of bounds
+     */
+    bool getPixel(int x, int y) const;
+
+    /**
+     * @brief Sets pixel by coordinates
+     * @param x X coordinate (0..width-1)
+     * @param y Y coordinate (0..height-1)
+     * @param white New color
+     * @throw std::out_of_range if coordinates are out of bounds
+     */
+    void setPixel(int x, int y, bool white);
+
+    /**
+     * @brief Sets pixels [x0, x1] of a row to one color
+     * @param y Y coordinate, must be within the raster
+     * @param x0 First X coordinate, must be within the raster
+     * @param x1 Last X coordinate (inclusive), must be within the raster
+     * @param white Fill color
+     *
+     * Coordinates are not checked: callers clip first. Inner words are
+     * stored whole, the two edge words are masked.
+     */
+    void fillSpan(int y, int x0, int x1, bool white);
+
+    /**
+     * @brief Sets the rectangle [x0, x1] x [y0, y1] to one color
+     * @param x0 Left X coordinate, must be within the raster
+     * @param y0 Top Y coordinate, must be within the raster
+     * @param x1 Right X coordinate (inclusive), must be within the raster
+     * @param y1 Bottom Y coordinate (inclusive), must be within the raster
+     * @param white Fill color
+     */
+    void fillRect(int x0, int y0, int x1, int y1, bool white);
+
+    /**
+     * @brief Draws a thick line clipped to the raster
+     * @param x0 Start X coordinate
+     * @param y0 Start Y coordinate
+     * @param x1 End X coordinate
+     * @param y1 End Y coordinate
+     * @param thickness Stroke width in pixels, as for the cross strategies
+     * @param white Line color
+     * @return Number of pixels drawn
+     */
+    uint64_t drawLine(int x0, int y0, int x1, int y1, unsigned int thickness, bool white);
+
+    /**
+     * @brief Counts white pixels in part of a row
+     * @param y Y coordinate, must be within the raster
+     * @param x_begin First X coordinate
+     * @param x_end X coordinate after the last one, at most width()
+     * @return Number of set bits
+     */
+    uint64_t countWhite(int y, int x_begin, int x_end) const;
+
+    /**
+     * @brief Saves the raster as a 1-bit palettized BMP
+     * @param filename Path to the file
+     * @return true if saving succeeded, false on error
+     */
+    bool save(const std::string& filename) const;
+
+private:
+    int width_ = 0;                 ///< Width in pixels
+    int height_ = 0;                ///< Height in pixels
+    bool top_down_ = false;         ///< Save rows top to bottom
+    size_t words_per_row_ = 0;      ///< Words per padded row
+    PooledVector<uint64_t> words_;  ///< Rows of packed bits
+};
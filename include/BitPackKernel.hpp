@@ -0,0 +1,68 @@
+/**
+ * @file BitPackKernel.hpp
+ * @brief Packing of black and white pixel rows into one bit per pixel
+ */
+
+#pragma once
+
+#include "BMPFile.hpp"
+#include "CpuFeatures.hpp"
+#include <cstdint>
+
+/**
+ * @class BitPackKernel
+ * @brief Packs rows of thresholded pixels eight to a byte
+ *
+ * Bits follow the 1bpp BMP layout: the first pixel of a byte is its most
+ * significant bit, and a set bit means white. A pixel counts as white when
+ * its green channel is at least 128, which is exact for the output of
+ * convertToBlackAndWhite(). All implementations produce identical bytes.
+ */
+class BitPackKernel {
+public:
+    /// Instruction set used by a kernel implementation
+    using Isa = SimdIsa;
+
+    /**
+     * @brief Gets the fastest kernel supported by the running CPU
+     * @return Kernel chosen once from CPUID
+     */
+    static const BitPackKernel& get();
+
+    /**
+     * @brief Gets kernel for a specific instruction set
+     * @param isa Requested instruction set
+     * @return Kernel, or nullptr if the CPU does not support it
+     */
+    static const BitPackKernel* forIsa(Isa isa);
+
+    /**
+     * @brief Packs a row of pixels
+     * @param src Source pixels (count elements)
+     * @param dst Destination, (count + 7) / 8 bytes; unused low bits of the last byte are cleared
+     * @param count Number of pixels
+     */
+    void pack(const BMPFile::Pixel* src, uint8_t* dst, int count) const { pack_(src, dst, count); }
+
+    /**
+     * @brief Gets instruction set of this kernel
+     * @return Instruction set
+     */
+    Isa isa() const { return isa_; }
+
+    /**
+     * @brief Gets human-readable kernel name
+     * @return Name of the instruction set
+     */
+    const char* name() const { return name_; }
+
+private:
+    using PackFn = void (*)(const BMPFile::Pixel* src, uint8_t* dst, int count);
+
+    BitPackKernel(Isa isa, const char* name, PackFn pack)
+        : isa_(isa), name_(name), pack_(pack) {}
+
+    Isa isa_;           ///< Instruction set
+    const char* name_;  ///< Display name
+    PackFn pack_;       ///< Kernel entry point
+};
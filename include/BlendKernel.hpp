@@ -0,0 +1,113 @@
+/**
+ * @file BlendKernel.hpp
+ * @brief Fixed-point source-over compositing of a solid color onto pixel runs
+ */
+
+#pragma once
+
+#include "BMPFile.hpp"
+#include "CpuFeatures.hpp"
+#include <cstdint>
+
+/**
+ * @class BlendKernel
+ * @brief Composites a translucent color over runs of BGR24 or BGRA32 pixels
+ *
+ * Every channel becomes (d * (255 - a) + s * a) / 255, rounded to nearest,
+ * where s * a is the premultiplied source and d the stored value. Alpha
+ * uses s = 255, so it accumulates as a + d * (1 - a). The division is
+ * done with shifts on 16-bit lanes, so all implementations agree exactly.
+ */
+class BlendKernel {
+public:
+    /// Instruction set used by a kernel implementation
+    using Isa = SimdIsa;
+
+    /**
+     * @struct Source
+     * @brief Stroke color prepared once for compositing
+     */
+    struct Source {
+        uint16_t inv = 0;       ///< 255 - alpha
+        uint16_t term[4] = {};  ///< Premultiplied B, G, R, A plus 128 for rounding
+
+        /**
+         * @brief Premultiplies a color by its alpha
+         * @param color Stroke color with straight alpha
+         */
+        explicit Source(BMPFile::Pixel color)
+            : inv(static_cast<uint16_t>(255 - color.a)),
+              term{static_cast<uint16_t>(color.b * color.a + 128),
+                   static_cast<uint16_t>(color.g * color.a + 128),
+                   static_cast<uint16_t>(color.r * color.a + 128),
+                   static_cast<uint16_t>(255 * color.a + 128)} {}
+
+        /**
+         * @brief Blends one stored channel value
+         * @param value Stored channel
+         * @param channel 0 = B, 1 = G, 2 = R, 3 = A
+         * @return Composited value
+         */
+        uint8_t blend(uint8_t value, int channel) const {
+            const uint32_t t = value * inv + term[channel];
+            return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+        }
+    };
+
+    /**
+     * @brief Gets the fastest kernel supported by the running CPU
+     * @return Kernel chosen once from CPUID
+     */
+    static const BlendKernel& get();
+
+    /**
+     * @brief Gets kernel for a specific instruction set
+     * @param isa Requested instruction set
+     * @return Kernel, or nullptr if the CPU does not support it
+     */
+    static const BlendKernel* forIsa(Isa isa);
+
+    /**
+     * @brief Composites the source over BGRA pixels (Pixel or BGRA32 rows)
+     * @param pixels First pixel
+     * @param count Number of pixels
+     * @param source Prepared color
+     */
+    void blend32(BMPFile::Pixel* pixels, int count, const Source& source) const {
+        blend32_(pixels, count, source);
+    }
+
+    /**
+     * @brief Composites the source over a BGR24 row
+     * @param bytes First byte of the first pixel
+     * @param count Number of pixels
+     * @param source Prepared color
+     */
+    void blend24(uint8_t* bytes, int count, const Source& source) const {
+        blend24_(bytes, count, source);
+    }
+
+    /**
+     * @brief Gets instruction set of this kernel
+     * @return Instruction set
+     */
+    Isa isa() const { return isa_; }
+
+    /**
+     * @brief Gets human-readable kernel name
+     * @return Name of the instruction set
+     */
+    const char* name() const { return name_; }
+
+private:
+    using Blend32Fn = void (*)(BMPFile::Pixel* pixels, int count, const Source& source);
+    using Blend24Fn = void (*)(uint8_t* bytes, int count, const Source& source);
+
+    BlendKernel(Isa isa, const char* name, Blend32Fn blend32, Blend24Fn blend24)
+        : isa_(isa), name_(name), blend32_(blend32), blend24_(blend24) {}
+
+    Isa isa_;             ///< Instruction set
+    const char* name_;    ///< Display name
+    Blend32Fn blend32_;   ///< BGRA entry point
+    Blend24Fn blend24_;   ///< BGR24 entry point
+};
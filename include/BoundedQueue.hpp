@@ -0,0 +1,80 @@
+/**
+ * @file BoundedQueue.hpp
+ * @brief Blocking FIFO queue with a fixed capacity
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/**
+ * @class BoundedQueue
+ * @brief Thread-safe FIFO that blocks producers while full
+ *
+ * Connects pipeline stages: the capacity bounds how far a fast stage may
+ * run ahead of a slow one, and with it the number of items in memory.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Maximum number of queued items (at least one)
+     */
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    /**
+     * @brief Appends an item, waiting while the queue is full
+     * @param value Item to append
+     * @return false if the queue was closed
+     */
+    bool push(T value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) return false;
+
+        items_.push_back(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item, waiting while the queue is empty
+     * @param value Receives the item
+     * @return false once the queue is closed and drained
+     */
+    bool pop(T& value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+
+        value = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Stops accepting items and wakes all waiting threads
+     *
+     * Items already queued can still be popped.
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;                   ///< Guards all members below
+    std::condition_variable not_full_;   ///< Signals free capacity
+    std::condition_variable not_empty_;  ///< Signals queued items
+    std::deque<T> items_;                ///< Queued items
+    size_t capacity_;                    ///< Maximum number of items
+    bool closed_ = false;                ///< No more pushes accepted
+};
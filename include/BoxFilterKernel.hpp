@@ -0,0 +1,69 @@
+/**
+ * @file BoxFilterKernel.hpp
+ * @brief 2x2 box filter used to build half-size image levels
+ */
+
+#pragma once
+
+#include "BMPFile.hpp"
+#include "CpuFeatures.hpp"
+
+/**
+ * @class BoxFilterKernel
+ * @brief Averages 2x2 pixel blocks of two rows into one half-width row
+ *
+ * Every channel, alpha included, becomes (a + b + c + d + 2) / 4, so all
+ * implementations produce identical results.
+ */
+class BoxFilterKernel {
+public:
+    /// Instruction set used by a kernel implementation
+    using Isa = SimdIsa;
+
+    /**
+     * @brief Gets the fastest kernel supported by the running CPU
+     * @return Kernel chosen once from CPUID
+     */
+    static const BoxFilterKernel& get();
+
+    /**
+     * @brief Gets kernel for a specific instruction set
+     * @param isa Requested instruction set
+     * @return Kernel, or nullptr if the CPU does not support it
+     */
+    static const BoxFilterKernel* forIsa(Isa isa);
+
+    /**
+     * @brief Downsamples two adjacent rows into one
+     * @param row0 Upper source row (at least 2 * count pixels)
+     * @param row1 Lower source row (at least 2 * count pixels)
+     * @param dst Destination row (count pixels)
+     * @param count Number of destination pixels
+     */
+    void apply(const BMPFile::Pixel* row0, const BMPFile::Pixel* row1, BMPFile::Pixel* dst, int count) const {
+        apply_(row0, row1, dst, count);
+    }
+
+    /**
+     * @brief Gets instruction set of this kernel
+     * @return Instruction set
+     */
+    Isa isa() const { return isa_; }
+
+    /**
+     * @brief Gets human-readable kernel name
+     * @return Name of the instruction set
+     */
+    const char* name() const { return name_; }
+
+private:
+    using ApplyFn = void (*)(const BMPFile::Pixel* row0, const BMPFile::Pixel* row1,
+                             BMPFile::Pixel* dst, int count);
+
+    BoxFilterKernel(Isa isa, const char* name, ApplyFn apply)
+        : isa_(isa), name_(name), apply_(apply) {}
+
+    Isa isa_;           ///< Instruction set
+    const char* name_;  ///< Display name
+    ApplyFn apply_;     ///< Kernel entry point
+};
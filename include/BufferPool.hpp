@@ -0,0 +1,173 @@
+/**
+ * @file BufferPool.hpp
+ * @brief Size-classed cache of large, page-aligned buffers
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class BufferPool
+ * @brief Recycles pixel and I/O buffers between images
+ *
+ * Requests are rounded up to a size class (four per power of two, so at
+ * most a quarter is wasted) and released blocks are kept on a free list
+ * per class. Once a workload has warmed up, images of similar size are
+ * served entirely from the lists. Blocks of 2 MiB and more are mapped
+ * in whole huge pages, starting on a huge page boundary, and advised as
+ * such; smaller ones come from the heap. Every block is aligned to 4096
+ * bytes.
+ *
+ * Only pooled blocks are counted. Per image, the steady state still
+ * allocates on the heap outside the pool: the stream buffer and FILE of
+ * every file opened (input, output and each mip level), one
+ * BoundedQueue node per image and batch stage, and pyramid level
+ * objects and mip file names with --mip. Per-thread scratch rows stop
+ * allocating once warmed up; thread pool tasks are stored inline, so a
+ * parallel loop costs about one task deque block rather than one
+ * allocation per task.
+ */
+class BufferPool {
+public:
+    /// Alignment of every block (enough for O_DIRECT)
+    static constexpr size_t kAlignment = 4096;
+
+    /// Blocks from this size up are mapped and backed by huge pages
+    static constexpr size_t kHugePageBytes = size_t(2) << 20;
+
+    /// Default limit on bytes kept in free lists
+    static constexpr size_t kDefaultCacheBytes = size_t(512) << 20;
+
+    BufferPool() = default;
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * @brief Gets pool shared by the whole process
+     * @return Pool used by PoolAllocator
+     */
+    static BufferPool& shared();
+
+    /**
+     * @brief Gets a block
+     * @param bytes Requested size
+     * @return Block of at least bytes, or nullptr for zero bytes
+     * @throws std::bad_alloc if the system is out of memory
+     */
+    void* acquire(size_t bytes);
+
+    /**
+     * @brief Returns a block for reuse
+     * @param block Block from acquire(), may be nullptr
+     * @param bytes Size passed to acquire()
+     *
+     * The block is freed instead if the free lists already hold the limit.
+     */
+    void release(void* block, size_t bytes);
+
+    /**
+     * @brief Frees every cached block
+     */
+    void trim();
+
+    /**
+     * @brief Sets how many bytes the free lists may hold
+     * @param bytes New limit; cached blocks above it are freed
+     */
+    void setCacheLimit(size_t bytes);
+
+    /**
+     * @brief Gets number of blocks obtained from the system so far
+     * @return Allocation count; stays flat in a warmed-up steady state
+     */
+    uint64_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets number of requests served from the free lists
+     * @return Reuse count
+     */
+    uint64_t reuses() const { return reuses_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Rounds a request up to its size class
+     * @param bytes Requested size
+     * @return Size of the block that serves it
+     */
+    static size_t classSize(size_t bytes);
+
+private:
+    /**
+     * @brief Gets a fresh block from the system
+     * @param size Class size
+     * @return Block
+     * @throws std::bad_alloc on failure
+     */
+    static void* allocateBlock(size_t size);
+
+    /**
+     * @brief Gives a block back to the system
+     * @param block Block from allocateBlock()
+     * @param size Class size
+     */
+    static void freeBlock(void* block, size_t size);
+
+    /**
+     * @brief Frees cached blocks, largest first, until the limit holds
+     *
+     * Called with mutex_ held.
+     */
+    void shrinkToLimit();
+
+    std::map<size_t, std::vector<void*>> free_;  ///< Cached blocks by class size
+    size_t cached_bytes_ = 0;                    ///< Bytes held in free_
+    size_t cache_limit_ = kDefaultCacheBytes;    ///< Limit on cached_bytes_
+    std::mutex mutex_;                           ///< Guards the fields above
+    std::atomic<uint64_t> allocations_{0};       ///< Blocks obtained from the system
+    std::atomic<uint64_t> reuses_{0};            ///< Requests served from free_
+};
+
+/**
+ * @class PoolAllocator
+ * @brief Standard allocator that draws from BufferPool::shared()
+ * @tparam T Element type
+ *
+ * Stateless, so containers using it move and swap like std::vector.
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    PoolAllocator() noexcept = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(BufferPool::shared().acquire(count * sizeof(T)));
+    }
+
+    void deallocate(T* block, size_t count) noexcept {
+        BufferPool::shared().release(block, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+/// Vector whose storage is recycled through BufferPool::shared()
+template <typename T>
+using PooledVector = std::vector<T, PoolAllocator<T>>;
@@ -0,0 +1,102 @@
+/**
+ * @file ConsoleRenderer.hpp
+ * @brief Buffered text rendering of images for the console
+ */
+
+#pragma once
+
+#include "BMPFile.hpp"
+#include "BinaryRaster.hpp"
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ConsoleRenderer
+ * @brief Renders an image as text, one character per output cell
+ *
+ * Each cell covers a box of source pixels and shows the foreground
+ * character if the average luma of the box is above the black and white
+ * threshold. The whole frame is built in memory and written at once.
+ */
+class ConsoleRenderer {
+public:
+    /**
+     * @brief Constructor
+     * @param chars Characters for bright and dark cells
+     * @param max_width Widest frame in characters (0 = image width)
+     * @param max_height Tallest frame in lines (0 = image height)
+     *
+     * Large images are downscaled by the same factor on both axes until
+     * they fit; images are never upscaled.
+     */
+    explicit ConsoleRenderer(std::pair<char, char> chars, int max_width = 0, int max_height = 0)
+        : chars_(chars), max_width_(max_width), max_height_(max_height) {}
+
+    /**
+     * @brief Gets the size of the terminal standard output is written to
+     * @return Columns and lines, leaving one line for the prompt, or
+     *         120x60 if standard output is not a terminal
+     */
+    static std::pair<int, int> terminalSize();
+
+    /**
+     * @brief Builds the text frame of an image
+     * @param image Image in any storage
+     * @return Lines of characters, each ending with a newline
+     */
+    std::string render(const BMPFile& image) const;
+
+    /**
+     * @brief Writes the text frame of an image with a single write
+     * @param image Image in any storage
+     * @param os Output stream
+     */
+    void render(const BMPFile& image, std::ostream& os) const;
+
+    /**
+     * @brief Builds the text frame of a bit-packed raster
+     * @param raster Black and white raster
+     * @return Lines of characters, each ending with a newline
+     *
+     * Cells count the white bits of their box a word at a time and match
+     * the frame of the equivalent thresholded BMPFile.
+     */
+    std::string render(const BinaryRaster& raster) const;
+
+    /**
+     * @brief Writes the text frame of a bit-packed raster with a single write
+     * @param raster Black and white raster
+     * @param os Output stream
+     */
+    void render(const BinaryRaster& raster, std::ostream& os) const;
+
+private:
+    std::pair<char, char> chars_;  ///< Bright and dark characters
+    int max_width_;                ///< Frame width limit (0 = none)
+    int max_height_;               ///< Frame height limit (0 = none)
+
+    /**
+     * @brief Computes frame size for an image
+     * @param width Image width
+     * @param height Image height
+     * @return Columns and lines of the frame
+     */
+    std::pair<int, int> frameSize(int width, int height) const;
+
+    /**
+     * @brief Splits image columns between frame columns
+     * @param width Image width
+     * @param cols Frame columns
+     * @return cols + 1 bounds; column c covers pixels [b[c], b[c + 1])
+     */
+    static std::vector<int> columnBounds(int width, int cols);
+
+    /**
+     * @brief Writes a frame with a single write
+     * @param frame Frame text
+     * @param os Output stream
+     */
+    static void write(const std::string& frame, std::ostream& os);
+};
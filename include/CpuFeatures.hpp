@@ -0,0 +1,56 @@
+/**
+ * @file CpuFeatures.hpp
+ * @brief Runtime detection of SIMD instruction sets
+ */
+
+#pragma once
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BMP_SIMD_X86 1
+/// Compiles a single function for the given instruction set
+#define BMP_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BMP_SIMD_X86 0
+#define BMP_TARGET(isa)
+#endif
+
+/**
+ * @enum SimdIsa
+ * @brief Instruction set targeted by a kernel implementation
+ */
+enum class SimdIsa {
+    Scalar,  ///< Portable one-pixel-at-a-time loops
+    SSSE3,   ///< 128-bit SSE up to SSSE3
+    AVX2     ///< 256-bit AVX2
+};
+
+/**
+ * @struct CpuFeatures
+ * @brief Instruction sets supported by the running CPU
+ */
+struct CpuFeatures {
+    bool sse2 = false;   ///< SSE2 available
+    bool ssse3 = false;  ///< SSSE3 available (pshufb)
+    bool sse41 = false;  ///< SSE4.1 available
+    bool avx2 = false;   ///< AVX2 available
+
+    /**
+     * @brief Gets features of the running CPU
+     * @return Features queried once from CPUID on first use
+     */
+    static const CpuFeatures& get();
+
+    /**
+     * @brief Checks if kernels for an instruction set can run
+     * @param isa Instruction set
+     * @return true if supported by this CPU and build
+     */
+    bool supports(SimdIsa isa) const {
+        switch (isa) {
+            case SimdIsa::Scalar: return true;
+            case SimdIsa::SSSE3: return BMP_SIMD_X86 && ssse3;
+            case SimdIsa::AVX2: return BMP_SIMD_X86 && ssse3 && avx2;
+        }
+        return false;
+    }
+};
@@ -4,6 +4,7 @@
 #include "Strategy/DrawCrossStrategy.hpp"
 #include "Strategy/DrawCrossOpenMPStrategy.hpp"
 #include "Strategy/DrawCrossThreadStrategy.hpp"
+#include "Strategy/DisplayListStrategy.hpp"
 
 /**
  * @class DrawStrategyFactory
@@ -39,4 +40,14 @@ public:
                 throw std::invalid_argument("Unknown strategy type");
         }
     }
+
+    /**
+     * @brief Creates a strategy that draws a display list instead of the cross
+     * @param list Primitives to draw, shared between strategies
+     * @param type NONE draws tiles on the calling thread, other types in parallel
+     * @return Unique pointer to the strategy implementation
+     */
+    static std::unique_ptr<IDrawStrategy> create(std::shared_ptr<const DisplayList> list, StrategyType type) {
+        return std::make_unique<DisplayListStrategy>(std::move(list), type != StrategyType::NONE);
+    }
 };
\ No newline at end of file
@@ -1,16 +1,76 @@
 #pragma once
 #include "BMPFile.hpp"
+#include "Raster/LineRasterizer.hpp"
 #include <memory>
 
+class BinaryRaster;
+
 class IDrawStrategy {
 public:
+    /**
+     * @struct Band
+     * @brief Placement of an image inside a larger canvas
+     *
+     * Used for banded processing: the image holds the canvas rows starting at
+     * row_offset, and only canvas rows [first_row, last_row) may be drawn.
+     */
+    struct Band {
+        int canvas_width = 0;   ///< Width of the full canvas
+        int canvas_height = 0;  ///< Height of the full canvas
+        int row_offset = 0;     ///< Canvas row stored in image row 0
+        int first_row = 0;      ///< First canvas row to draw into
+        int last_row = 0;       ///< Canvas row after the last one to draw into
+
+        /**
+         * @brief Gets the area whose stroke pixels this band accounts for
+         * @return The band rows at any column; the top and bottom bands also
+         *         take the rows beyond their edge of the canvas
+         *
+         * The areas of all bands tile the plane, so clipped pixels summed
+         * over the bands count what lies outside the canvas exactly once.
+         */
+        ClipRect statsArea() const {
+            constexpr int kFar = LineRasterizer::kFar;
+            return {-kFar, first_row == 0 ? -kFar : first_row,
+                    kFar, last_row == canvas_height ? kFar : last_row - 1};
+        }
+    };
+
     virtual ~IDrawStrategy() = default;
     
     /**
      * @brief Main drawing method
      * @param image Reference to BMP image to draw on
      */
-    virtual void draw(BMPFile& image) = 0;
+    virtual void draw(BMPFile& image) {
+        drawBand(image, {image.width(), image.height(), 0, 0, image.height()});
+    }
+
+    /**
+     * @brief Draws the part of the figure that falls into a band of the canvas
+     * @param image Band image holding consecutive canvas rows
+     * @param band Canvas size, the image's first row and the rows to draw
+     */
+    virtual void drawBand(BMPFile& image, const Band& band) = 0;
+
+    /**
+     * @brief Checks if drawBinary() gives the same result as drawing before thresholding
+     * @return true if the figure can be drawn onto a thresholded raster
+     *
+     * Holds for opaque colors: every stroke pixel then thresholds to the
+     * color's own black or white, whatever was under it.
+     */
+    virtual bool canDrawBinary() const { return false; }
+
+    /**
+     * @brief Draws the figure onto a thresholded image
+     * @param raster Bit-packed image in the canvas orientation
+     * @throw std::logic_error if canDrawBinary() is false
+     */
+    virtual void drawBinary(BinaryRaster& raster) {
+        (void)raster;
+        throw std::logic_error("Strategy cannot draw on a binary raster");
+    }
     
     /**
      * @brief Gets the name of the drawing strategy
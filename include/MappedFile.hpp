@@ -0,0 +1,82 @@
+/**
+ * @file MappedFile.hpp
+ * @brief RAII wrapper around a memory-mapped file
+ */
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class MappedFile
+ * @brief Maps a whole file into memory for zero-copy access
+ *
+ * The mapping is always private: in copy-on-write mode pages become
+ * writable, but modifications are never written back to the file.
+ * Pages are faulted in lazily, so opening a large file is cheap.
+ */
+class MappedFile {
+public:
+    /**
+     * @enum Mode
+     * @brief Access mode of the mapping
+     */
+    enum class Mode {
+        ReadOnly,    ///< Pages are read-only
+        CopyOnWrite  ///< Pages are writable, changes stay private to the process
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Maps a file into memory, replacing any previous mapping
+     * @param filename Path to the file
+     * @param mode Access mode of the mapping
+     * @return true if mapping succeeded, false on error
+     */
+    bool open(const std::string& filename, Mode mode);
+
+    /**
+     * @brief Unmaps the file (no-op if nothing is mapped)
+     */
+    void close();
+
+    /**
+     * @brief Checks if a file is currently mapped
+     * @return true if mapped, false otherwise
+     */
+    bool isOpen() const { return data_ != nullptr; }
+
+    /**
+     * @brief Checks if the mapped pages may be modified
+     * @return true in copy-on-write mode, false otherwise
+     */
+    bool isWritable() const { return isOpen() && mode_ == Mode::CopyOnWrite; }
+
+    /**
+     * @brief Gets start of the mapped bytes
+     * @return Pointer to the first byte of the file
+     */
+    uint8_t* data() { return data_; }
+    const uint8_t* data() const { return data_; }
+
+    /**
+     * @brief Gets size of the mapping
+     * @return Size in bytes
+     */
+    size_t size() const { return size_; }
+
+private:
+    uint8_t* data_ = nullptr;        ///< Start of the mapping
+    size_t size_ = 0;                ///< Mapped size in bytes
+    Mode mode_ = Mode::ReadOnly;     ///< Access mode
+};
@@ -0,0 +1,262 @@
+/**
+ * @file DisplayList.hpp
+ * @brief Recorded drawing primitives rasterized as row spans
+ */
+
+#pragma once
+
+#include "BMPFile.hpp"
+#include "Raster/LineRasterizer.hpp"
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class DisplayList
+ * @brief Ordered list of lines, polylines, rectangles and circles to draw
+ *
+ * Primitives are recorded first and rasterized later, clipped to any
+ * rectangle, as horizontal spans that never overlap on a row. Strokes
+ * follow the cross lines: a thickness t covers t / 2 pixels on each side
+ * of the outline. A polyline or polygon is one primitive, so the pixels
+ * its segments share at the vertices are drawn once.
+ */
+class DisplayList {
+public:
+    /**
+     * @struct Primitive
+     * @brief One recorded shape
+     */
+    struct Primitive {
+        /**
+         * @enum Kind
+         * @brief Shape of a primitive
+         */
+        enum class Kind {
+            Line,         ///< Segment (x0, y0) - (x1, y1)
+            Polyline,     ///< Connected segments through points, bounded by (x0, y0) - (x1, y1)
+            Rect,         ///< Rectangle outline with corners (x0, y0) and (x1, y1)
+            FilledRect,   ///< Solid rectangle with corners (x0, y0) and (x1, y1)
+            Circle,       ///< Circle outline around (x0, y0) with radius x1
+            FilledCircle  ///< Solid disc around (x0, y0) with radius x1
+        };
+
+        Kind kind = Kind::Line;  ///< Shape
+        int x0 = 0;              ///< First X coordinate or center X
+        int y0 = 0;              ///< First Y coordinate or center Y
+        int x1 = 0;              ///< Second X coordinate or radius
+        int y1 = 0;              ///< Second Y coordinate (unused by circles)
+        int half = 0;            ///< Stroke half-width (thickness / 2)
+        BMPFile::Pixel color;    ///< Fill color
+        std::vector<std::pair<int, int>> points;  ///< Polyline vertices, closed ones end at the first again
+    };
+
+    /**
+     * @brief Records a line
+     * @param thickness Stroke thickness in pixels
+     */
+    void addLine(int x0, int y0, int x1, int y1, BMPFile::Pixel color, unsigned int thickness);
+
+    /**
+     * @brief Records a rectangle given two opposite corners (inclusive)
+     * @param filled Fill the inside instead of stroking the outline
+     */
+    void addRect(int x0, int y0, int x1, int y1, BMPFile::Pixel color, unsigned int thickness,
+                 bool filled = false);
+
+    /**
+     * @brief Records connected line segments as one primitive
+     * @param points Vertices in drawing order
+     * @param closed Also connect the last vertex to the first
+     */
+    void addPolyline(const std::vector<std::pair<int, int>>& points, BMPFile::Pixel color,
+                     unsigned int thickness, bool closed = false);
+
+    /**
+     * @brief Records a circle
+     * @param radius Radius in pixels
+     * @param filled Fill the disc instead of stroking the outline
+     */
+    void addCircle(int cx, int cy, int radius, BMPFile::Pixel color, unsigned int thickness,
+                   bool filled = false);
+
+    /**
+     * @brief Gets recorded primitives in drawing order
+     * @return Primitives
+     */
+    const std::vector<Primitive>& primitives() const { return primitives_; }
+
+    /**
+     * @brief Gets number of recorded primitives
+     * @return Count
+     */
+    size_t size() const { return primitives_.size(); }
+
+    /**
+     * @brief Checks if nothing was recorded
+     * @return true if the list is empty
+     */
+    bool empty() const { return primitives_.empty(); }
+
+    /**
+     * @brief Reads primitives from a text file
+     * @param filename Path to the file
+     * @param color Color until the file sets one
+     * @param thickness Thickness until the file sets one
+     * @return Display list in file order
+     * @throw std::runtime_error if the file cannot be read or a line is malformed
+     *
+     * One command per line, '#' starts a comment:
+     * color R,G,B[,A] | thickness N | line x0 y0 x1 y1 |
+     * rect x0 y0 x1 y1 | fillrect x0 y0 x1 y1 | polyline x y x y ... |
+     * polygon x y x y ... | circle cx cy r | fillcircle cx cy r
+     *
+     * Coordinates, radii and thicknesses beyond LineRasterizer::kMaxCoordinate
+     * are rejected so the stepping math cannot overflow.
+     */
+    static DisplayList load(const std::string& filename, BMPFile::Pixel color, unsigned int thickness);
+
+    /**
+     * @brief Gets the rectangle a primitive can touch
+     * @param primitive Primitive
+     * @return Inclusive bounds, stroke included
+     */
+    static ClipRect bounds(const Primitive& primitive);
+
+    /**
+     * @brief Counts the pixels of a primitive inside a rectangle
+     * @param primitive Primitive
+     * @param rect Rectangle to count in, may reach out to +-LineRasterizer::kFar
+     * @return Number of pixels forEachSpan visits with that clip
+     */
+    static uint64_t pixelCount(const Primitive& primitive, const ClipRect& rect);
+
+    /**
+     * @brief Visits the pixels of a primitive inside a rectangle as row spans
+     * @param primitive Primitive
+     * @param rect Clip rectangle
+     * @param fn Callable invoked as fn(y, x_left, x_right), bounds inclusive
+     *
+     * Spans on the same row never overlap, so every pixel is visited once.
+     */
+    template <typename Fn>
+    static void forEachSpan(const Primitive& primitive, const ClipRect& rect, Fn&& fn) {
+        using Kind = Primitive::Kind;
+        switch (primitive.kind) {
+            case Kind::Line:
+                LineRasterizer(primitive.x0, primitive.y0, primitive.x1, primitive.y1)
+                    .forEachSpan(rect, primitive.half, fn);
+                break;
+            case Kind::Polyline:
+                for (const Span& span : polylineSpans(primitive, rect)) fn(span.y, span.left, span.right);
+                break;
+            case Kind::Rect:
+            case Kind::FilledRect:
+                rectSpans(primitive, rect, fn);
+                break;
+            case Kind::Circle:
+            case Kind::FilledCircle:
+                circleSpans(primitive, rect, fn);
+                break;
+        }
+    }
+
+private:
+    /**
+     * @struct Span
+     * @brief Inclusive run of pixels on one row
+     */
+    struct Span {
+        int y;      ///< Row
+        int left;   ///< First column
+        int right;  ///< Last column
+    };
+
+    std::vector<Primitive> primitives_;  ///< Recorded primitives
+
+    /**
+     * @brief Rasterizes a polyline as the union of its segments
+     * @param p Polyline primitive
+     * @param rect Clip rectangle
+     * @return Spans sorted by row and column, valid until the next call on this thread
+     */
+    static const std::vector<Span>& polylineSpans(const Primitive& p, const ClipRect& rect);
+
+    /**
+     * @brief Emits the clipped part of [left, right] on row y
+     */
+    template <typename Fn>
+    static void emit(const ClipRect& rect, int y, int64_t left, int64_t right, Fn& fn) {
+        left = std::max<int64_t>(left, rect.left);
+        right = std::min<int64_t>(right, rect.right);
+        if (left <= right) fn(y, static_cast<int>(left), static_cast<int>(right));
+    }
+
+    /**
+     * @brief Rasterizes rectangle outlines and fills
+     */
+    template <typename Fn>
+    static void rectSpans(const Primitive& p, const ClipRect& rect, Fn& fn) {
+        const int64_t left = std::min(p.x0, p.x1);
+        const int64_t right = std::max(p.x0, p.x1);
+        const int64_t top = std::min(p.y0, p.y1);
+        const int64_t bottom = std::max(p.y0, p.y1);
+        const int half = p.half;
+
+        const int first = static_cast<int>(std::max<int64_t>(rect.top, top - half));
+        const int last = static_cast<int>(std::min<int64_t>(rect.bottom, bottom + half));
+        for (int y = first; y <= last; ++y) {
+            // Rows crossing the top or bottom edge, or between close sides, are one run
+            const bool edge_row = y <= top + half || y >= bottom - half;
+            if (p.kind == Primitive::Kind::FilledRect || edge_row || left + half + 1 >= right - half) {
+                emit(rect, y, left - half, right + half, fn);
+            } else {
+                emit(rect, y, left - half, left + half, fn);
+                emit(rect, y, right - half, right + half, fn);
+            }
+        }
+    }
+
+    /**
+     * @brief Rasterizes circle outlines and discs
+     *
+     * A pixel at offset (dx, dy) from the center is covered when its
+     * distance is below outer + 1/2 and, for outlines, not below
+     * inner - 1/2, where outer and inner are the radius +- half.
+     */
+    template <typename Fn>
+    static void circleSpans(const Primitive& p, const ClipRect& rect, Fn& fn) {
+        const int64_t outer = static_cast<int64_t>(p.x1) + p.half;
+        const int64_t inner = p.kind == Primitive::Kind::Circle ? static_cast<int64_t>(p.x1) - p.half : 0;
+        const int64_t outer_sq = outer * outer + outer;
+        const int64_t inner_sq = inner > 0 ? inner * inner - inner : -1;
+
+        const int first = static_cast<int>(std::max<int64_t>(rect.top, p.y0 - outer));
+        const int last = static_cast<int>(std::min<int64_t>(rect.bottom, p.y0 + outer));
+        for (int y = first; y <= last; ++y) {
+            const int64_t dy_sq = static_cast<int64_t>(y - p.y0) * (y - p.y0);
+            const int64_t reach = isqrt(outer_sq - dy_sq);
+            if (inner_sq < dy_sq) {
+                emit(rect, y, p.x0 - reach, p.x0 + reach, fn);
+                continue;
+            }
+            // Pixels with dx^2 <= inner_sq - dy^2 are inside the hole
+            const int64_t hole = isqrt(inner_sq - dy_sq);
+            emit(rect, y, p.x0 - reach, p.x0 - hole - 1, fn);
+            emit(rect, y, p.x0 + hole + 1, p.x0 + reach, fn);
+        }
+    }
+
+    /**
+     * @brief Gets the integer square root
+     * @param value Non-negative value
+     * @return Largest r with r * r <= value
+     */
+    static int64_t isqrt(int64_t value) {
+        int64_t root = static_cast<int64_t>(std::sqrt(static_cast<double>(value)));
+        while (root * root > value) --root;
+        while ((root + 1) * (root + 1) <= value) ++root;
+        return root;
+    }
+};
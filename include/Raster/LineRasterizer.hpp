@@ -0,0 +1,314 @@
+/**
+ * @file LineRasterizer.hpp
+ * @brief Bresenham line stepping with clipping before rasterization
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @struct ClipRect
+ * @brief Inclusive rectangle that limits rasterization
+ */
+struct ClipRect {
+    int left = 0;    ///< Leftmost column
+    int top = 0;     ///< Topmost row
+    int right = -1;  ///< Rightmost column (inclusive)
+    int bottom = -1; ///< Bottommost row (inclusive)
+};
+
+/**
+ * @class LineRasterizer
+ * @brief Bresenham line between two points with closed-form stepping state
+ *
+ * The line is normalized to a major axis (one step per pixel) and a minor
+ * axis (moves by at most one per step), exactly as the classic loop does.
+ * The minor coordinate and error term after any number of steps are known
+ * in closed form, so a line can be clipped on its step index before it is
+ * rasterized and stepping can start anywhere on it with the same pixels
+ * the full loop would produce.
+ */
+class LineRasterizer {
+public:
+    /// Largest coordinate magnitude and stroke thickness the int stepping math can hold
+    static constexpr int kMaxCoordinate = 1 << 29;
+
+    /// Bounds far outside any image, yet safe to expand by any stamp half-width
+    static constexpr int kFar = std::numeric_limits<int>::max() / 4;
+
+    /**
+     * @brief Sets up the line from (x0, y0) to (x1, y1), both inclusive
+     */
+    LineRasterizer(int x0, int y0, int x1, int y1);
+
+    /**
+     * @brief Gets number of steps (pixels) on the line
+     * @return Length along the major axis plus one
+     */
+    int steps() const { return dx_ + 1; }
+
+    /**
+     * @brief Checks if the major axis is Y
+     * @return true for steep lines
+     */
+    bool steep() const { return steep_; }
+
+    /**
+     * @brief Finds the steps whose stamps can touch a rectangle
+     * @param rect Clip rectangle
+     * @param half Stamp half-width (stamp covers point +- half on both axes)
+     * @param k_begin Receives first step to rasterize
+     * @param k_end Receives step after the last one to rasterize
+     * @return false if no stamp touches the rectangle
+     *
+     * Parametric (Liang-Barsky style) clipping solved exactly on the
+     * Bresenham step index, so the result matches testing every step.
+     */
+    bool clip(const ClipRect& rect, int half, int& k_begin, int& k_end) const;
+
+    /**
+     * @brief Counts the pixels of the thick stroke inside a rectangle
+     * @param rect Rectangle to count in, may reach out to +-kFar
+     * @param half Stamp half-width
+     * @return Number of pixels forEachSpan covers with that clip
+     */
+    uint64_t strokePixels(const ClipRect& rect, int half) const;
+
+    /**
+     * @brief Gets the major-axis extent of the stroke inside a rectangle
+     * @param rect Clip rectangle
+     * @param half Stamp half-width
+     * @param first Receives first major coordinate the stroke covers
+     * @param last Receives last major coordinate the stroke covers
+     * @return false if no stamp touches the rectangle
+     */
+    bool majorExtent(const ClipRect& rect, int half, int& first, int& last) const;
+
+    /**
+     * @brief Narrows a rectangle to a slab of major-axis coordinates
+     * @param rect Clip rectangle
+     * @param first First major coordinate of the slab
+     * @param last Last major coordinate of the slab
+     * @return Rectangle limited to the slab
+     *
+     * Slabs that partition the major extent split the stroke into
+     * disjoint pieces: rasterizing each one with forEachSpan gives the
+     * same pixels as the whole stroke, every pixel in exactly one slab.
+     */
+    ClipRect majorSlab(const ClipRect& rect, int first, int last) const {
+        ClipRect slab = rect;
+        if (steep_) {
+            slab.top = std::max(rect.top, first);
+            slab.bottom = std::min(rect.bottom, last);
+        } else {
+            slab.left = std::max(rect.left, first);
+            slab.right = std::min(rect.right, last);
+        }
+        return slab;
+    }
+
+    /**
+     * @brief Visits the thick stroke as one horizontal span per row
+     * @param rect Clip rectangle
+     * @param half Stamp half-width (stamp covers point +- half on both axes)
+     * @param fn Callable invoked as fn(y, x_left, x_right), bounds inclusive
+     *
+     * Covers exactly the pixels of a square stamp at every step, clipped
+     * to the rectangle, but writes each of them once: the union of the
+     * stamps is a single run on every row, found from the closed-form
+     * steps that reach the row.
+     *
+     * Steepness and the half-widths of thickness 1, 2, 3 and 5 are
+     * resolved here once, into loops with both fixed at compile time.
+     */
+    template <typename Fn>
+    void forEachSpan(const ClipRect& rect, int half, Fn&& fn) const {
+        int k_begin = 0;
+        int k_end = 0;
+        if (!clip(rect, half, k_begin, k_end)) return;
+
+        switch (half) {
+            case 0:
+                spans<0>(rect, half, k_begin, k_end, fn);
+                break;
+            case 1:
+                spans<1>(rect, half, k_begin, k_end, fn);
+                break;
+            case 2:
+                spans<2>(rect, half, k_begin, k_end, fn);
+                break;
+            default:
+                spans<kAnyHalf>(rect, half, k_begin, k_end, fn);
+                break;
+        }
+    }
+
+private:
+    /**
+     * @struct Cursor
+     * @brief Bresenham state at one step, advanced incrementally
+     */
+    struct Cursor {
+        int k;      ///< Step index
+        int minor;  ///< Minor coordinate at the step
+        int error;  ///< Error term before plotting the step
+
+        Cursor(const LineRasterizer& line, int step)
+            : k(step),
+              minor(line.y0_ + line.ystep_ * line.minorSteps(step)),
+              error(line.errorAt(step)) {}
+
+        void advanceTo(const LineRasterizer& line, int step) {
+            for (; k < step; ++k) {
+                error -= line.dy_;
+                if (error < 0) {
+                    minor += line.ystep_;
+                    error += line.dx_;
+                }
+            }
+        }
+    };
+
+    /**
+     * @class StepCache
+     * @brief Remembers firstStepReaching() for the last few minor offsets
+     * @tparam Size Number of offsets kept
+     *
+     * Adjacent rows of a shallow stroke ask for overlapping offsets, so
+     * with a fixed stamp size every row computes one new step instead of two.
+     */
+    template <int Size>
+    class StepCache {
+    public:
+        StepCache() { std::fill(keys_, keys_ + Size, std::numeric_limits<int64_t>::min()); }
+
+        int64_t get(const LineRasterizer& line, int64_t m) {
+            const size_t slot = static_cast<size_t>(((m % Size) + Size) % Size);
+            if (keys_[slot] != m) {
+                keys_[slot] = m;
+                values_[slot] = line.firstStepReaching(m);
+            }
+            return values_[slot];
+        }
+
+    private:
+        int64_t keys_[Size];         ///< Offset held by each slot
+        int64_t values_[Size] = {};  ///< First step reaching the offset
+    };
+
+    /// Half-width template argument that reads the width at run time
+    static constexpr int kAnyHalf = -1;
+
+    /**
+     * @brief Picks the span loop for the line's major axis
+     * @tparam Half Stamp half-width, or kAnyHalf to use half
+     */
+    template <int Half, typename Fn>
+    void spans(const ClipRect& rect, int half, int k_begin, int k_end, Fn& fn) const {
+        if (steep_) steepSpans<Half>(rect, half, k_begin, k_end, fn);
+        else shallowSpans<Half>(rect, half, k_begin, k_end, fn);
+    }
+
+    /**
+     * @brief Rows are the major axis: each row sees a window of steps
+     */
+    template <int Half, typename Fn>
+    void steepSpans(const ClipRect& rect, int runtime_half, int k_begin, int k_end, Fn& fn) const {
+        const int half = Half == kAnyHalf ? runtime_half : Half;
+        const int k_last = k_end - 1;
+        const int top = std::max(rect.top, x0_ + k_begin - half);
+        const int bottom = std::min(rect.bottom, x0_ + k_last + half);
+
+        if constexpr (Half == 0) {
+            // A one-pixel stamp puts exactly one step on every row
+            Cursor at(*this, top - x0_);
+            for (int y = top; y <= bottom; ++y) {
+                at.advanceTo(*this, y - x0_);
+                if (at.minor >= rect.left && at.minor <= rect.right) fn(y, at.minor, at.minor);
+            }
+        } else {
+            Cursor lo(*this, std::max(k_begin, top - half - x0_));
+            Cursor hi(*this, std::min(k_last, top + half - x0_));
+            for (int y = top; y <= bottom; ++y) {
+                lo.advanceTo(*this, std::max(k_begin, y - half - x0_));
+                hi.advanceTo(*this, std::min(k_last, y + half - x0_));
+                const int left = std::max(rect.left, std::min(lo.minor, hi.minor) - half);
+                const int right = std::min(rect.right, std::max(lo.minor, hi.minor) + half);
+                if (left <= right) fn(y, left, right);
+            }
+        }
+    }
+
+    /**
+     * @brief Rows are the minor axis: each row sees a run of steps
+     */
+    template <int Half, typename Fn>
+    void shallowSpans(const ClipRect& rect, int runtime_half, int k_begin, int k_end, Fn& fn) const {
+        const int half = Half == kAnyHalf ? runtime_half : Half;
+        const int k_last = k_end - 1;
+        const int first = y0_ + ystep_ * minorSteps(k_begin);
+        const int last = y0_ + ystep_ * minorSteps(k_last);
+        const int top = std::max(rect.top, std::min(first, last) - half);
+        const int bottom = std::min(rect.bottom, std::max(first, last) + half);
+
+        // Row y needs the offsets n_lo and n_lo + 2 * half + 1; the next row
+        // shifts both by one, so a fixed stamp size lets them be reused
+        constexpr int kCacheSize = Half == kAnyHalf ? 1 : 2 * Half + 2;
+        StepCache<kCacheSize> cache;
+        auto reaching = [&](int64_t m) {
+            if constexpr (Half == kAnyHalf) return firstStepReaching(m);
+            else return cache.get(*this, m);
+        };
+
+        for (int y = top; y <= bottom; ++y) {
+            const int64_t n_lo = ystep_ > 0 ? y - half - y0_ : y0_ - y - half;
+            const int64_t n_hi = n_lo + 2 * half;
+            const int64_t ka = std::max<int64_t>(k_begin, reaching(n_lo));
+            const int64_t kb = std::min<int64_t>(k_last, reaching(n_hi + 1) - 1);
+            if (ka > kb) continue;
+
+            const int left = std::max<int64_t>(rect.left, x0_ + ka - half);
+            const int right = std::min<int64_t>(rect.right, x0_ + kb + half);
+            if (left <= right) fn(y, left, right);
+        }
+    }
+
+    bool steep_;  ///< Major axis is Y
+    int x0_;      ///< Major coordinate of the first point
+    int y0_;      ///< Minor coordinate of the first point
+    int dx_;      ///< Length along the major axis
+    int dy_;      ///< Length along the minor axis
+    int ystep_;   ///< Minor direction (+1 or -1)
+    int e0_;      ///< Initial error term
+
+    /**
+     * @brief Gets number of minor steps taken before step k
+     * @param k Step index
+     * @return Minor offset from the first point (unsigned)
+     */
+    int minorSteps(int k) const {
+        if (dx_ == 0) return 0;
+        return static_cast<int>((static_cast<int64_t>(k) * dy_ - e0_ + dx_ - 1) / dx_);
+    }
+
+    /**
+     * @brief Gets error term at step k
+     * @param k Step index
+     * @return Error value the loop holds before plotting step k
+     */
+    int errorAt(int k) const {
+        return static_cast<int>(e0_ - static_cast<int64_t>(k) * dy_ +
+                                static_cast<int64_t>(minorSteps(k)) * dx_);
+    }
+
+    /**
+     * @brief Finds the first step after at least m minor steps
+     * @param m Required number of minor steps
+     * @return Step index, or steps() if the line never gets there
+     */
+    int64_t firstStepReaching(int64_t m) const;
+};
@@ -0,0 +1,58 @@
+/**
+ * @file RowBandScheduler.hpp
+ * @brief Partition of canvas rows into per-worker bands
+ */
+
+#pragma once
+
+#include "Raster/LineRasterizer.hpp"
+#include <algorithm>
+
+/**
+ * @class RowBandScheduler
+ * @brief Splits a row range into contiguous bands, one per worker
+ *
+ * Each worker rasterizes only the part of every primitive that falls in
+ * its own band. Bands never share a row, so workers never write the same
+ * pixel and only touch a shared cache line where two bands meet.
+ */
+class RowBandScheduler {
+public:
+    /**
+     * @brief Splits rows [first_row, end_row) into bands
+     * @param first_row First row to draw
+     * @param end_row Row after the last one to draw
+     * @param workers Number of workers (bands never exceed rows)
+     */
+    RowBandScheduler(int first_row, int end_row, int workers)
+        : first_row_(first_row),
+          rows_(std::max(0, end_row - first_row)),
+          bands_(std::clamp(workers, 1, std::max(1, rows_))) {}
+
+    /**
+     * @brief Gets number of bands
+     * @return Band count, at least one
+     */
+    int bands() const { return bands_; }
+
+    /**
+     * @brief Gets clip rectangle of a band
+     * @param index Band index (0..bands()-1)
+     * @param left Leftmost column to draw
+     * @param right Rightmost column to draw (inclusive)
+     * @return Rectangle covering the band's rows, empty if it has none
+     */
+    ClipRect band(int index, int left, int right) const {
+        // Spread the remainder so band heights differ by at most one row
+        const int base = rows_ / bands_;
+        const int extra = rows_ % bands_;
+        const int top = first_row_ + index * base + std::min(index, extra);
+        const int height = base + (index < extra ? 1 : 0);
+        return {left, top, right, top + height - 1};
+    }
+
+private:
+    int first_row_;  ///< First row of the range
+    int rows_;       ///< Number of rows in the range
+    int bands_;      ///< Number of bands
+};
@@ -0,0 +1,98 @@
+/**
+ * @file SpanPainter.hpp
+ * @brief Row span writers specialized for one pixel layout and color mode
+ */
+
+#pragma once
+
+#include "BMPFile.hpp"
+#include "BlendKernel.hpp"
+#include <algorithm>
+#include <utility>
+
+/**
+ * @class SpanPainter
+ * @brief Writes pre-clipped spans of one color into rows of one layout
+ * @tparam Format Stored pixel layout
+ * @tparam Blend true to composite with BlendKernel, false to overwrite
+ *
+ * Storage, orientation, pixel format and opacity are all fixed before the
+ * first span, so painting a span is an address computation and a fill or
+ * one kernel call. Obtain painters through withSpanPainter().
+ */
+template <BMPFile::PixelFormat Format, bool Blend>
+class SpanPainter {
+public:
+    /**
+     * @brief Prepares the painter
+     * @param layout Rows to paint
+     * @param color Span color
+     */
+    SpanPainter(const BMPFile::RowLayout& layout, BMPFile::Pixel color)
+        : layout_(layout), color_(color), source_(color), kernel_(BlendKernel::get()) {}
+
+    /**
+     * @brief Paints pixels [x0, x1] of a row
+     * @param y Y coordinate, must be within the image
+     * @param x0 First X coordinate, must be within the image
+     * @param x1 Last X coordinate (inclusive), must be within the image
+     */
+    void operator()(int y, int x0, int x1) const {
+        uint8_t* row = layout_.row(y);
+        if constexpr (Format == BMPFile::PixelFormat::BGRA32) {
+            BMPFile::Pixel* px = reinterpret_cast<BMPFile::Pixel*>(row);
+            if constexpr (Blend) kernel_.blend32(px + x0, x1 - x0 + 1, source_);
+            else std::fill(px + x0, px + x1 + 1, color_);
+        } else if constexpr (Blend) {
+            kernel_.blend24(row + x0 * 3, x1 - x0 + 1, source_);
+        } else {
+            for (uint8_t* q = row + x0 * 3, *end = row + (x1 + 1) * 3; q != end; q += 3) {
+                q[0] = color_.b;
+                q[1] = color_.g;
+                q[2] = color_.r;
+            }
+        }
+    }
+
+private:
+    BMPFile::RowLayout layout_;   ///< Rows to paint
+    BMPFile::Pixel color_;        ///< Fill color
+    BlendKernel::Source source_;  ///< Color prepared for compositing
+    const BlendKernel& kernel_;   ///< Fastest kernel for the running CPU
+};
+
+/**
+ * @brief Calls fn with the painter for a row layout and color
+ * @param layout Rows to paint
+ * @param color Span color; opaque colors fill, others composite source-over
+ * @param fn Callable invoked once as fn(painter), where painter(y, x0, x1)
+ *           paints one pre-clipped span
+ *
+ * The layout and opacity are resolved here, once per stroke, so fn is
+ * instantiated for each painter and its span loop carries no branches on
+ * them. A fully transparent color still calls fn, leaving pixels unchanged.
+ */
+template <typename Fn>
+void withSpanPainter(const BMPFile::RowLayout& layout, BMPFile::Pixel color, Fn&& fn) {
+    using Format = BMPFile::PixelFormat;
+    const bool blend = color.a != 255;
+    if (layout.format == Format::BGRA32) {
+        if (blend) fn(SpanPainter<Format::BGRA32, true>(layout, color));
+        else fn(SpanPainter<Format::BGRA32, false>(layout, color));
+    } else {
+        if (blend) fn(SpanPainter<Format::BGR24, true>(layout, color));
+        else fn(SpanPainter<Format::BGR24, false>(layout, color));
+    }
+}
+
+/**
+ * @brief Calls fn with the painter for an image and color
+ * @param image Image to paint, must not be mapped read-only
+ * @param color Span color
+ * @param fn Callable invoked once as fn(painter)
+ * @throw std::logic_error if the image is mapped read-only
+ */
+template <typename Fn>
+void withSpanPainter(BMPFile& image, BMPFile::Pixel color, Fn&& fn) {
+    withSpanPainter(image.rowLayout(), color, std::forward<Fn>(fn));
+}
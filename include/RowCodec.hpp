@@ -0,0 +1,111 @@
+/**
+ * @file RowCodec.hpp
+ * @brief Conversion of whole pixel rows between on-disk and in-memory layout
+ */
+
+#pragma once
+
+#include "BMPFile.hpp"
+#include "CpuFeatures.hpp"
+#include <cstdint>
+
+/**
+ * @class RowCodec
+ * @brief Converts rows between BGR24/BGRA32 file layout and BMPFile::Pixel
+ *
+ * BGR24 rows are expanded and compacted with byte shuffles; BGRA32 already
+ * matches the Pixel layout and is copied. The best implementation for the
+ * running CPU is selected once, on first use.
+ */
+class RowCodec {
+public:
+    /// Instruction set used by a codec implementation
+    using Isa = SimdIsa;
+
+    /// Row conversion from one on-disk format to pixels
+    using DecodeFn = void (*)(const uint8_t* src, BMPFile::Pixel* dst, int count);
+
+    /// Row conversion from pixels to one on-disk format
+    using EncodeFn = void (*)(const BMPFile::Pixel* src, uint8_t* dst, int count);
+
+    /**
+     * @brief Gets the fastest codec supported by the running CPU
+     * @return Codec chosen once from CPUID
+     */
+    static const RowCodec& get();
+
+    /**
+     * @brief Gets codec for a specific instruction set
+     * @param isa Requested instruction set
+     * @return Codec, or nullptr if the CPU does not support it
+     */
+    static const RowCodec* forIsa(Isa isa);
+
+    /**
+     * @brief Converts one on-disk row to pixels
+     * @param format On-disk pixel format of src
+     * @param src First byte of the row
+     * @param dst Destination pixels (count elements)
+     * @param count Number of pixels
+     */
+    void decode(BMPFile::PixelFormat format, const uint8_t* src, BMPFile::Pixel* dst, int count) const {
+        if (format == BMPFile::PixelFormat::BGR24) decode24_(src, dst, count);
+        else decode32_(src, dst, count);
+    }
+
+    /**
+     * @brief Converts pixels to one on-disk row (padding is left untouched)
+     * @param format On-disk pixel format of dst
+     * @param src Source pixels (count elements)
+     * @param dst First byte of the row
+     * @param count Number of pixels
+     */
+    void encode(BMPFile::PixelFormat format, const BMPFile::Pixel* src, uint8_t* dst, int count) const {
+        if (format == BMPFile::PixelFormat::BGR24) encode24_(src, dst, count);
+        else encode32_(src, dst, count);
+    }
+
+    /**
+     * @brief Gets instruction set of this codec
+     * @return Instruction set
+     */
+    Isa isa() const { return isa_; }
+
+    /**
+     * @brief Gets human-readable codec name
+     * @return Name of the instruction set
+     */
+    const char* name() const { return name_; }
+
+    /**
+     * @brief Gets the decoder for one on-disk format
+     * @param format On-disk pixel format
+     * @return Function called as decode(src, dst, count), for loops that
+     *         convert many rows of the same format
+     */
+    DecodeFn decoder(BMPFile::PixelFormat format) const {
+        return format == BMPFile::PixelFormat::BGR24 ? decode24_ : decode32_;
+    }
+
+    /**
+     * @brief Gets the encoder for one on-disk format
+     * @param format On-disk pixel format
+     * @return Function called as encode(src, dst, count)
+     */
+    EncodeFn encoder(BMPFile::PixelFormat format) const {
+        return format == BMPFile::PixelFormat::BGR24 ? encode24_ : encode32_;
+    }
+
+private:
+    RowCodec(Isa isa, const char* name, DecodeFn decode24, EncodeFn encode24,
+             DecodeFn decode32, EncodeFn encode32)
+        : isa_(isa), name_(name), decode24_(decode24), encode24_(encode24),
+          decode32_(decode32), encode32_(encode32) {}
+
+    Isa isa_;             ///< Instruction set
+    const char* name_;    ///< Display name
+    DecodeFn decode24_;   ///< BGR24 -> Pixel
+    EncodeFn encode24_;   ///< Pixel -> BGR24
+    DecodeFn decode32_;   ///< BGRA32 -> Pixel
+    EncodeFn encode32_;   ///< Pixel -> BGRA32
+};
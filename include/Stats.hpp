@@ -0,0 +1,142 @@
+/**
+ * @file Stats.hpp
+ * @brief Process-wide stage timers and counters for --stats reports
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @class Stats
+ * @brief Global instrumentation switched on by --stats
+ *
+ * While disabled every hook is a single predictable branch on a relaxed
+ * flag: timers do not read the clock and counters do not touch shared
+ * cache lines. Counters and times are summed over all threads.
+ */
+class Stats {
+public:
+    /**
+     * @enum Stage
+     * @brief Timed pipeline stages
+     */
+    enum class Stage {
+        Load,       ///< Reading or mapping input pixels
+        Draw,       ///< Drawing strategy
+        Threshold,  ///< Black and white conversion
+        Save,       ///< Encoding and writing output
+        Display,    ///< Console preview
+        Count
+    };
+
+    /**
+     * @enum Counter
+     * @brief Accumulated quantities
+     */
+    enum class Counter {
+        BytesRead,          ///< Bytes read or mapped from input files
+        BytesWritten,       ///< Bytes written to output files
+        PixelsTouched,      ///< Pixels written by drawing strategies
+        PixelsClipped,      ///< Stroke pixels skipped because they fell outside the drawn area
+        BufferAllocations,  ///< Pixel and I/O buffers obtained from the system
+        BufferReuses,       ///< Pixel and I/O buffers served from the BufferPool cache
+        Count
+    };
+
+    /**
+     * @brief Checks if instrumentation is on
+     * @return true after setEnabled(true)
+     */
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Turns instrumentation on or off and clears all values
+     * @param on New state
+     */
+    static void setEnabled(bool on);
+
+    /**
+     * @brief Adds to a counter (no-op while disabled)
+     * @param counter Counter to increase
+     * @param value Amount to add
+     */
+    static void add(Counter counter, uint64_t value) {
+        if (enabled()) counters_[static_cast<int>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Records pixels drawn for a stroke and the part clipped away
+     * @param stroke_pixels Pixels the whole stroke covers
+     * @param drawn_pixels Pixels actually written
+     */
+    static void addStroke(uint64_t stroke_pixels, uint64_t drawn_pixels) {
+        add(Counter::PixelsTouched, drawn_pixels);
+        add(Counter::PixelsClipped, stroke_pixels - drawn_pixels);
+    }
+
+    /**
+     * @brief Gets a counter value
+     * @param counter Counter to read
+     * @return Accumulated value
+     */
+    static uint64_t get(Counter counter) {
+        return counters_[static_cast<int>(counter)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets accumulated time of a stage
+     * @param stage Stage to read
+     * @return Time in seconds
+     */
+    static double seconds(Stage stage) {
+        return nanos_[static_cast<int>(stage)].load(std::memory_order_relaxed) * 1e-9;
+    }
+
+    /**
+     * @brief Writes all values as a JSON object
+     * @param os Output stream
+     * @param strategy Name of the drawing strategy
+     */
+    static void writeJson(std::ostream& os, const std::string& strategy);
+
+    /**
+     * @class ScopedTimer
+     * @brief Adds the lifetime of the object to a stage
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Stage stage) : stage_(stage), active_(enabled()) {
+            if (active_) start_ = std::chrono::steady_clock::now();
+        }
+
+        ~ScopedTimer() {
+            if (!active_) return;
+            const auto elapsed = std::chrono::steady_clock::now() - start_;
+            nanos_[static_cast<int>(stage_)].fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                std::memory_order_relaxed);
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Stage stage_;                                  ///< Stage being timed
+        bool active_;                                  ///< Stats were on at construction
+        std::chrono::steady_clock::time_point start_;  ///< Start time
+    };
+
+private:
+    static constexpr int kStages = static_cast<int>(Stage::Count);
+    static constexpr int kCounters = static_cast<int>(Counter::Count);
+
+    static inline std::atomic<bool> enabled_{false};
+    static inline std::atomic<uint64_t> counters_[kCounters] = {};
+    static inline std::atomic<uint64_t> nanos_[kStages] = {};
+    static inline std::chrono::steady_clock::time_point started_{};
+};
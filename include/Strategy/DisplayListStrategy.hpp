@@ -0,0 +1,54 @@
+#pragma once
+#include "IDrawStrategy.hpp"
+#include "Raster/DisplayList.hpp"
+#include <memory>
+
+/**
+ * @class DisplayListStrategy
+ * @brief Draws a display list in tiles, each tile once with all its primitives
+ *
+ * Primitives are binned by the tiles their bounds overlap, then every tile
+ * draws its primitives in list order clipped to itself. Tiles never share
+ * pixels, so they run in parallel on the shared thread pool and the result
+ * matches drawing the list front to back.
+ */
+class DisplayListStrategy : public IDrawStrategy {
+public:
+    /**
+     * @brief Constructor
+     * @param list Primitives to draw (shared, never modified)
+     * @param parallel Draw tiles on the shared thread pool
+     */
+    explicit DisplayListStrategy(std::shared_ptr<const DisplayList> list, bool parallel = true);
+
+    void drawBand(BMPFile& image, const Band& band) override;
+
+    /// True when every primitive is opaque
+    bool canDrawBinary() const override;
+
+    /// Draws the primitives in list order on the calling thread
+    void drawBinary(BinaryRaster& raster) override;
+
+    std::string getName() const override;
+
+    /// Primitives carry their own colors; this only sets the reported default
+    void setColor(const BMPFile::Pixel& color) override;
+    BMPFile::Pixel getColor() const override;
+
+    /// Primitives carry their own thickness; this only sets the reported default
+    void setThickness(unsigned int thickness) override;
+    unsigned int getThickness() const override;
+
+private:
+    /**
+     * @brief Counts the pixels all primitives cover inside an area, clipped or not
+     * @param area Area to count in
+     * @return Pixel count, for the clipped pixel statistics
+     */
+    uint64_t strokePixels(const ClipRect& area) const;
+
+    std::shared_ptr<const DisplayList> list_;
+    bool parallel_;
+    BMPFile::Pixel color_ = {0, 0, 0, 255};
+    unsigned int thickness_ = 1;
+};
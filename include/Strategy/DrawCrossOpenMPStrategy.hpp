@@ -1,5 +1,6 @@
 #pragma once
 #include "IDrawStrategy.hpp"
+#include "Raster/LineRasterizer.hpp"
 #include <cmath>
 #include <omp.h>
 
@@ -7,7 +8,8 @@
  * @class DrawCrossOpenMPStrategy
  * @brief OpenMP-optimized implementation of cross drawing strategy
  * 
- * Uses OpenMP directives for parallel pixel drawing operations
+ * Splits the canvas rows into one band per OpenMP thread; every thread
+ * draws the whole cross clipped to its own band
  */
 class DrawCrossOpenMPStrategy : public IDrawStrategy {
 public:
@@ -20,7 +22,9 @@ public:
                              unsigned int thickness = 1)
         : color_(color), thickness_(thickness) {}
 
-    void draw(BMPFile& image) override;
+    void drawBand(BMPFile& image, const Band& band) override;
+    bool canDrawBinary() const override { return color_.a == 255; }
+    void drawBinary(BinaryRaster& raster) override;
     std::string getName() const override { return "Cross Drawing Strategy (OpenMP)"; }
     
     void setColor(const BMPFile::Pixel& color) override { color_ = color; }
@@ -35,6 +39,7 @@ private:
     BMPFile::Pixel color_;
     unsigned int thickness_;
 
-    void drawLine(BMPFile& image, int x0, int y0, int x1, int y1);
-    void drawThickPixel(BMPFile& image, int x, int y);
+    template <typename Painter>
+    uint64_t drawLine(const Painter& paint, const Band& band, const ClipRect& clip,
+                      const LineRasterizer& line);
 };
\ No newline at end of file
@@ -18,7 +18,9 @@ public:
     explicit DrawCrossStrategy(BMPFile::Pixel color = {0, 0, 0, 255}, 
                             unsigned int thickness = 1);
 
-    void draw(BMPFile& image) override;
+    void drawBand(BMPFile& image, const Band& band) override;
+    bool canDrawBinary() const override { return color_.a == 255; }
+    void drawBinary(BinaryRaster& raster) override;
     std::string getName() const override;
     
     void setColor(const BMPFile::Pixel& color) override;
@@ -27,10 +29,20 @@ public:
     void setThickness(unsigned int thickness) override;
     unsigned int getThickness() const override;
 
+    /**
+     * @brief Draws the cross onto a thresholded raster in the color's black or white
+     * @param raster Bit-packed image
+     * @param color Opaque stroke color
+     * @param thickness Stroke thickness
+     *
+     * Shared by all cross strategies: whole 64-pixel words are set per row,
+     * so a single thread is enough.
+     */
+    static void drawCross(BinaryRaster& raster, BMPFile::Pixel color, unsigned int thickness);
+
 private:
     BMPFile::Pixel color_;
     unsigned int thickness_;
 
-    void drawLine(BMPFile& image, int x0, int y0, int x1, int y1);
-    void drawThickPixel(BMPFile& image, int x, int y);
+    void drawLine(BMPFile& image, const Band& band, int x0, int y0, int x1, int y1);
 };
\ No newline at end of file
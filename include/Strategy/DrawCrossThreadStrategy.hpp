@@ -1,15 +1,13 @@
 #pragma once
 #include "IDrawStrategy.hpp"
 #include <cmath>
-#include <thread>
-#include <vector>
-#include <mutex>
 
 /**
  * @class DrawCrossThreadStrategy
  * @brief Thread-based implementation of cross drawing strategy
  * 
- * Uses std::thread for parallel pixel drawing with workload balancing
+ * Draws on the shared thread pool, which steals work between threads
+ * and keeps its workers alive between lines and images
  */
 class DrawCrossThreadStrategy : public IDrawStrategy {
 public:
@@ -21,7 +19,9 @@ public:
     explicit DrawCrossThreadStrategy(BMPFile::Pixel color = {0, 0, 0, 255},
                                   unsigned int thickness = 1);
 
-    void draw(BMPFile& image) override;
+    void drawBand(BMPFile& image, const Band& band) override;
+    bool canDrawBinary() const override { return color_.a == 255; }
+    void drawBinary(BinaryRaster& raster) override;
     std::string getName() const override;
     
     void setColor(const BMPFile::Pixel& color) override;
@@ -33,9 +33,6 @@ public:
 private:
     BMPFile::Pixel color_;
     unsigned int thickness_;
-    mutable std::mutex mutex_;
 
-    void drawLine(BMPFile& image, int x0, int y0, int x1, int y1);
-    void drawThickPixel(BMPFile& image, int x, int y);
-    void drawThickPixelArea(BMPFile& image, int x, int y);
+    void drawLine(BMPFile& image, const Band& band, int x0, int y0, int x1, int y1);
 };
\ No newline at end of file
@@ -0,0 +1,109 @@
+/**
+ * @file ThreadPool.hpp
+ * @brief Persistent worker threads with work stealing
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Reusable workers that run batches of tasks
+ *
+ * Every worker owns a task deque: it pops its own work from the back and
+ * steals from the front of other deques when it runs dry. The thread that
+ * submits a batch runs tasks too until the batch is done, so batches may
+ * be submitted from inside a task without deadlocking.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Starts the workers
+     * @param workers Number of worker threads (the caller adds one more)
+     */
+    explicit ThreadPool(unsigned workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Gets pool shared by the whole process
+     * @return Pool sized to the hardware concurrency
+     */
+    static ThreadPool& shared();
+
+    /**
+     * @brief Gets number of threads that run a batch
+     * @return Workers plus the calling thread
+     */
+    unsigned concurrency() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    /**
+     * @brief Runs task(i) for every i in [0, count) and waits for all of them
+     * @param count Number of tasks
+     * @param task Task body
+     * @throws Rethrows the first exception thrown by a task
+     */
+    void run(size_t count, const std::function<void(size_t)>& task);
+
+    /**
+     * @brief Splits [begin, end) into chunks and runs them in parallel
+     * @param begin First index
+     * @param end Index after the last one
+     * @param min_chunk Smallest chunk worth a task
+     * @param fn Callable invoked as fn(chunk_begin, chunk_end)
+     */
+    template <typename Fn>
+    void parallelFor(int begin, int end, int min_chunk, Fn&& fn) {
+        const int total = end - begin;
+        if (total <= 0) return;
+
+        // A few chunks per thread let stealing even out uneven chunks
+        const int target = static_cast<int>(concurrency()) * 4;
+        const int chunk = std::max({1, min_chunk, (total + target - 1) / target});
+        const size_t chunks = static_cast<size_t>((total + chunk - 1) / chunk);
+        if (chunks == 1) {
+            fn(begin, end);
+            return;
+        }
+
+        // Passed by reference so std::function keeps it inline instead of on the heap
+        const auto body = [&](size_t i) {
+            const int lo = begin + static_cast<int>(i) * chunk;
+            fn(lo, std::min(lo + chunk, end));
+        };
+        run(chunks, std::cref(body));
+    }
+
+private:
+    /**
+     * @struct Queue
+     * @brief Task deque of one worker
+     */
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;  ///< One deque per worker
+    std::vector<std::thread> workers_;            ///< Worker threads
+    std::mutex wake_mutex_;                       ///< Guards sleeping workers
+    std::condition_variable wake_;                ///< Signals new tasks or shutdown
+    std::atomic<size_t> pending_{0};              ///< Tasks waiting in deques
+    std::atomic<size_t> next_queue_{0};           ///< Round-robin submit target
+    bool stop_ = false;                           ///< Shutdown flag
+
+    void workerLoop(size_t index);
+    bool runOne(size_t preferred);
+};
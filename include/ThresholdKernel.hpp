@@ -0,0 +1,94 @@
+/**
+ * @file ThresholdKernel.hpp
+ * @brief Fixed-point luma threshold used for black and white conversion
+ */
+
+#pragma once
+
+#include "BMPFile.hpp"
+#include "CpuFeatures.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class ThresholdKernel
+ * @brief Turns pixels pure black or white by their luma, keeping alpha
+ *
+ * Luma is computed as 299*R + 587*G + 114*B in integers and compared with
+ * 128000, which matches the reference formula
+ * (uint8_t)(0.299*R + 0.587*G + 0.114*B) > 127. Sums landing exactly on
+ * the threshold round either way in double precision, so those rare
+ * pixels are resolved with the reference formula itself and the output is
+ * bit-identical to it.
+ */
+class ThresholdKernel {
+public:
+    /// Instruction set used by a kernel implementation
+    using Isa = SimdIsa;
+
+    static constexpr uint32_t kWeightR = 299;    ///< Red weight, scaled by 1000
+    static constexpr uint32_t kWeightG = 587;    ///< Green weight, scaled by 1000
+    static constexpr uint32_t kWeightB = 114;    ///< Blue weight, scaled by 1000
+    static constexpr uint32_t kTie = 128000;     ///< Scaled luma of the threshold
+
+    /**
+     * @brief Decides the reference black/white result for one color
+     * @return true if the pixel becomes white
+     */
+    static bool isWhite(uint8_t r, uint8_t g, uint8_t b) {
+        const uint32_t luma = kWeightR * r + kWeightG * g + kWeightB * b;
+        if (luma != kTie) return luma > kTie;
+        return static_cast<uint8_t>(0.299 * r + 0.587 * g + 0.114 * b) > 127;
+    }
+
+    /**
+     * @brief Gets the fastest kernel supported by the running CPU
+     * @return Kernel chosen once from CPUID
+     */
+    static const ThresholdKernel& get();
+
+    /**
+     * @brief Gets kernel for a specific instruction set
+     * @param isa Requested instruction set
+     * @return Kernel, or nullptr if the CPU does not support it
+     */
+    static const ThresholdKernel* forIsa(Isa isa);
+
+    /**
+     * @brief Thresholds a run of pixels in place
+     * @param pixels First pixel
+     * @param count Number of pixels
+     */
+    void apply(BMPFile::Pixel* pixels, size_t count) const { apply_(pixels, count); }
+
+    /**
+     * @brief Thresholds a run of packed 3-byte BGR pixels in place
+     * @param bytes First byte of the run, as stored in a BGR24 row
+     * @param count Number of pixels
+     */
+    void applyBGR24(uint8_t* bytes, size_t count) const { apply_bgr24_(bytes, count); }
+
+    /**
+     * @brief Gets instruction set of this kernel
+     * @return Instruction set
+     */
+    Isa isa() const { return isa_; }
+
+    /**
+     * @brief Gets human-readable kernel name
+     * @return Name of the instruction set
+     */
+    const char* name() const { return name_; }
+
+private:
+    using ApplyFn = void (*)(BMPFile::Pixel* pixels, size_t count);
+    using ApplyBGR24Fn = void (*)(uint8_t* bytes, size_t count);
+
+    ThresholdKernel(Isa isa, const char* name, ApplyFn apply, ApplyBGR24Fn apply_bgr24)
+        : isa_(isa), name_(name), apply_(apply), apply_bgr24_(apply_bgr24) {}
+
+    Isa isa_;                    ///< Instruction set
+    const char* name_;           ///< Display name
+    ApplyFn apply_;              ///< Kernel entry point
+    ApplyBGR24Fn apply_bgr24_;   ///< Entry point for packed BGR24 rows
+};
@@ -0,0 +1,224 @@
+/**
+ * @file AsyncFileWriter.cpp
+ * @brief Implementation of the background file writer
+ */
+
+#include "AsyncFileWriter.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+
+AsyncFileWriter::~AsyncFileWriter() {
+    close();
+}
+
+/**
+ * @brief Creates the file, allocates buffers and starts the writer
+ * @param filename Path to the file
+ * @param options Buffering and I/O settings
+ * @param expected_size Final file size if known
+ * @return true on success, false on error
+ */
+bool AsyncFileWriter::open(const std::string& filename, const Options& options, uint64_t expected_size) {
+    close();
+
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    direct_ = false;
+#ifdef O_DIRECT
+    // Not every filesystem accepts O_DIRECT; fall back to buffered writes
+    if (options.direct) {
+        fd_ = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+        direct_ = fd_ >= 0;
+    }
+#endif
+    if (fd_ < 0) fd_ = ::open(filename.c_str(), flags, 0644);
+    if (fd_ < 0) return false;
+
+    if (options.preallocate && expected_size > 0) {
+        // Only a hint: the writes themselves still extend the file if this fails
+        ::posix_fallocate(fd_, 0, static_cast<off_t>(expected_size));
+    }
+
+    buffer_bytes_ = std::max(options.buffer_bytes, 2 * kAlignment);
+    buffer_bytes_ = (buffer_bytes_ + kAlignment - 1) / kAlignment * kAlignment;
+
+    // Pool blocks are page-aligned and reused across files of similar size
+    static_assert(BufferPool::kAlignment % kAlignment == 0, "Pool blocks must suit O_DIRECT");
+    storage_.resize(std::max(2u, options.buffers));
+    for (auto& buffer : storage_) {
+        try {
+            buffer.data = {static_cast<uint8_t*>(BufferPool::shared().acquire(buffer_bytes_)),
+                           PoolDeleter{buffer_bytes_}};
+        } catch (const std::bad_alloc&) {
+            storage_.clear();
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        free_.push_back(&buffer);
+    }
+
+    offset_ = 0;
+    failed_ = false;
+    stop_ = false;
+    thread_ = std::thread(&AsyncFileWriter::writerLoop, this);
+    return true;
+}
+
+/**
+ * @brief Gets a contiguous block of the current buffer
+ * @param bytes Block size, at most bufferBytes()
+ * @return Pointer to the block
+ */
+uint8_t* AsyncFileWriter::reserve(size_t bytes) {
+    if (current_ && current_->used + bytes > buffer_bytes_) submit(false);
+    if (!current_) current_ = acquire();
+    return current_->data.get() + current_->used;
+}
+
+/**
+ * @brief Appends a reserved block
+ * @param bytes Number of bytes filled
+ */
+void AsyncFileWriter::commit(size_t bytes) {
+    current_->used += bytes;
+    offset_ += bytes;
+}
+
+/**
+ * @brief Appends bytes through the buffers
+ * @param data Source bytes
+ * @param bytes Number of bytes
+ */
+void AsyncFileWriter::write(const void* data, size_t bytes) {
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    while (bytes > 0) {
+        // A full buffer ends on a block boundary, so nothing is carried over
+        if (available() == 0) submit(false);
+        const size_t n = std::min(bytes, available());
+        std::memcpy(reserve(n), src, n);
+        commit(n);
+        src += n;
+        bytes -= n;
+    }
+}
+
+/**
+ * @brief Flushes buffered data and closes the file
+ * @return true if every write succeeded
+ */
+bool AsyncFileWriter::close() {
+    if (fd_ < 0) return true;
+
+    submit(true);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    changed_.notify_all();
+    thread_.join();
+
+    // Block padding and preallocation may both leave the file too long
+    if (::ftruncate(fd_, static_cast<off_t>(offset_)) != 0) failed_ = true;
+    if (::close(fd_) != 0) failed_ = true;
+    fd_ = -1;
+
+    free_.clear();
+    full_.clear();
+    storage_.clear();
+    current_ = nullptr;
+    return !failed_;
+}
+
+/**
+ * @brief Queues the current buffer for writing
+ * @param final No more data follows, so the tail is written padded
+ */
+void AsyncFileWriter::submit(bool final) {
+    if (!current_) return;
+
+    Buffer* buffer = current_;
+    current_ = nullptr;
+
+    // O_DIRECT needs block-aligned offsets: carry the unaligned tail over
+    const size_t tail = (direct_ && !final) ? buffer->used % kAlignment : 0;
+    if (tail > 0) {
+        current_ = acquire();
+        buffer->used -= tail;
+        std::memcpy(current_->data.get(), buffer->data.get() + buffer->used, tail);
+        current_->offset = buffer->offset + buffer->used;
+        current_->used = tail;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (buffer->used > 0) full_.push_back(buffer);
+        else free_.push_back(buffer);
+    }
+    changed_.notify_all();
+}
+
+/**
+ * @brief Takes a free buffer, waiting for the writer if there is none
+ * @return Empty buffer positioned at the current end of data
+ */
+AsyncFileWriter::Buffer* AsyncFileWriter::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return !free_.empty(); });
+    Buffer* buffer = free_.front();
+    free_.pop_front();
+
+    buffer->used = 0;
+    buffer->offset = offset_;
+    return buffer;
+}
+
+/**
+ * @brief Body of the writer thread
+ */
+void AsyncFileWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        changed_.wait(lock, [this] { return stop_ || !full_.empty(); });
+        if (full_.empty()) return;
+
+        Buffer* buffer = full_.front();
+        full_.pop_front();
+
+        lock.unlock();
+        const bool ok = writeBuffer(*buffer);
+        lock.lock();
+
+        if (!ok) failed_ = true;
+        free_.push_back(buffer);
+        changed_.notify_all();
+    }
+}
+
+/**
+ * @brief Writes one buffer at its file offset
+ * @param buffer Filled buffer
+ * @return true if all bytes were written
+ */
+bool AsyncFileWriter::writeBuffer(const Buffer& buffer) {
+    size_t size = buffer.used;
+    if (direct_) {
+        // Pad the tail to a whole block; close() truncates it away
+        const size_t padded = (size + kAlignment - 1) / kAlignment * kAlignment;
+        std::memset(buffer.data.get() + size, 0, padded - size);
+        size = padded;
+    }
+
+    size_t done = 0;
+    while (done < size) {
+        const ssize_t n = ::pwrite(fd_, buffer.data.get() + done, size - done,
+                                   static_cast<off_t>(buffer.offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
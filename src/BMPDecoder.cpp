@@ -0,0 +1,349 @@
+/**
+ * @file BMPDecoder.cpp
+ * @brief Palette, bitfield and RLE decoders for BMP input
+ */
+
+#include "BMPDecoder.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+/// Bytes of compressed data read per refill
+constexpr size_t kRleChunkBytes = 1 << 20;
+
+/// Offset of the masks: inside a V2+ header or right after a 40-byte one
+constexpr std::streamoff kMasksOffset = sizeof(BMPFile::BMPHeader) + 40;
+
+/**
+ * @class RleReader
+ * @brief Buffered byte source over the compressed pixel data
+ *
+ * Ops never span more than 258 bytes, so a refill only has to move the
+ * unread tail of the buffer to its front before reading the next chunk.
+ */
+class RleReader {
+public:
+    /**
+     * @brief Constructor
+     * @param file Stream positioned at the pixel data
+     * @param size Compressed size, 0 to read until the end of the file
+     */
+    RleReader(std::istream& file, uint32_t size)
+        : file_(file), left_(size ? size : std::numeric_limits<uint64_t>::max()), buffer_(kRleChunkBytes) {}
+
+    /**
+     * @brief Makes bytes available, reading more of the file if needed
+     * @param n Bytes needed
+     * @return false if the data ends first
+     */
+    bool fill(size_t n) {
+        if (end_ - pos_ >= n) return true;
+
+        consumed_ += pos_;
+        std::memmove(buffer_.data(), buffer_.data() + pos_, end_ - pos_);
+        end_ -= pos_;
+        pos_ = 0;
+        const size_t want = static_cast<size_t>(std::min<uint64_t>(buffer_.size() - end_, left_));
+        file_.read(reinterpret_cast<char*>(buffer_.data() + end_), static_cast<std::streamsize>(want));
+        const size_t got = static_cast<size_t>(file_.gcount());
+        end_ += got;
+        left_ -= got;
+        return end_ - pos_ >= n;
+    }
+
+    /**
+     * @brief Makes bytes available that the current op needs
+     * @param n Bytes needed
+     * @throws std::runtime_error if the data ends first
+     */
+    void require(size_t n) {
+        if (!fill(n)) throw std::runtime_error("Truncated RLE data");
+    }
+
+    /**
+     * @brief Takes the next byte (after fill or require)
+     * @return Byte value
+     */
+    uint8_t byte() { return buffer_[pos_++]; }
+
+    /**
+     * @brief Takes the next bytes (after fill or require)
+     * @param n Number of bytes
+     * @return First byte
+     */
+    const uint8_t* take(size_t n) {
+        const uint8_t* data = buffer_.data() + pos_;
+        pos_ += n;
+        return data;
+    }
+
+    /**
+     * @brief Gets number of bytes taken so far
+     * @return Consumed compressed bytes
+     */
+    uint64_t consumed() const { return consumed_ + pos_; }
+
+private:
+    std::istream& file_;             ///< Compressed data source
+    uint64_t left_;                  ///< Bytes not read from the file yet
+    PooledVector<uint8_t> buffer_;   ///< Read buffer
+    size_t pos_ = 0;                 ///< Next unread byte
+    size_t end_ = 0;                 ///< End of buffered bytes
+    uint64_t consumed_ = 0;          ///< Bytes taken before the last refill
+};
+
+/**
+ * @brief Writes one pixel into a row of a given layout
+ * @tparam Format Destination pixel layout
+ * @param row First byte of the row
+ * @param x X coordinate
+ * @param color Pixel color
+ */
+template <BMPFile::PixelFormat Format>
+void putPixel(uint8_t* row, int x, const BMPFile::Pixel& color) {
+    if constexpr (Format == BMPFile::PixelFormat::BGRA32) {
+        std::memcpy(row + x * 4, &color, sizeof(color));
+    } else {
+        uint8_t* p = row + x * 3;
+        p[0] = color.b;
+        p[1] = color.g;
+        p[2] = color.r;
+    }
+}
+
+} // namespace
+
+BMPDecoder::BMPDecoder(std::istream& file, const BMPFile::BMPHeader& bmp_header,
+                       const BMPFile::DIBHeader& dib_header)
+    : width_(dib_header.width), height_(std::abs(dib_header.height)), bits_(dib_header.bits_per_pixel) {
+    if (bmp_header.signature != 0x4D42)
+        throw std::runtime_error("Not a BMP file");
+    if (dib_header.header_size < sizeof(BMPFile::DIBHeader))
+        throw std::runtime_error("Unsupported BMP header");
+    if (width_ <= 0 || dib_header.height == 0 || dib_header.height == std::numeric_limits<int32_t>::min())
+        throw std::runtime_error("Invalid image dimensions");
+
+    stored_row_size_ = (static_cast<size_t>(width_) * bits_ + 31) / 32 * 4;
+    const uint32_t compression = dib_header.compression;
+
+    if (bits_ == 1 || bits_ == 4 || bits_ == 8) {
+        rle_ = (bits_ == 8 && compression == kRle8) || (bits_ == 4 && compression == kRle4);
+        if (compression != kRgb && !rle_)
+            throw std::runtime_error("Unsupported BMP compression");
+        if (rle_ && dib_header.height < 0)
+            throw std::runtime_error("Top-down RLE BMP is invalid");
+        rle_size_ = dib_header.image_size;
+
+        // The color table follows the information header
+        const uint32_t max_colors = 1u << bits_;
+        const uint32_t colors_used = dib_header.colors_used;
+        const uint32_t colors = colors_used ? std::min(colors_used, max_colors) : max_colors;
+        uint8_t entries[256 * 4];
+        file.seekg(sizeof(BMPFile::BMPHeader) + dib_header.header_size, std::ios::beg);
+        file.read(reinterpret_cast<char*>(entries), colors * 4);
+        if (!file) throw std::runtime_error("Truncated BMP color table");
+        for (uint32_t i = 0; i < colors; ++i) {
+            palette_[i] = BMPFile::Pixel(entries[i * 4 + 2], entries[i * 4 + 1], entries[i * 4]);
+        }
+
+        // Table entries expand a whole byte of 1 or 4-bit indices at once
+        if (bits_ == 1) {
+            table_.resize(256 * 8);
+            for (int byte = 0; byte < 256; ++byte) {
+                for (int bit = 0; bit < 8; ++bit) {
+                    table_[byte * 8 + bit] = palette_[(byte >> (7 - bit)) & 1];
+                }
+            }
+            decode_row_ = decodeIndexed1;
+        } else if (bits_ == 4) {
+            table_.resize(256 * 2);
+            for (int byte = 0; byte < 256; ++byte) {
+                table_[byte * 2] = palette_[byte >> 4];
+                table_[byte * 2 + 1] = palette_[byte & 15];
+            }
+            decode_row_ = decodeIndexed4;
+        } else {
+            decode_row_ = decodeIndexed8;
+        }
+        return;
+    }
+
+    if (bits_ != 16 && bits_ != 32)
+        throw std::runtime_error("Unsupported BMP bit depth");
+    if (compression != kBitfields && compression != kAlphaBitfields && !(bits_ == 16 && compression == kRgb))
+        throw std::runtime_error("Unsupported BMP compression");
+
+    // Uncompressed 16-bit images are 5-5-5; otherwise the masks are stored
+    uint32_t masks[4] = {0x7C00, 0x03E0, 0x001F, 0};
+    if (compression != kRgb) {
+        const bool alpha = compression == kAlphaBitfields || dib_header.header_size >= 56;
+        masks[3] = 0;
+        file.seekg(kMasksOffset, std::ios::beg);
+        file.read(reinterpret_cast<char*>(masks), (alpha ? 4 : 3) * sizeof(uint32_t));
+        if (!file) throw std::runtime_error("Truncated BMP color masks");
+    }
+    if (bits_ == 16 && (masks[0] | masks[1] | masks[2] | masks[3]) > 0xFFFF)
+        throw std::runtime_error("Invalid BMP color masks");
+
+    channels_[0] = makeChannel(masks[2]);
+    channels_[1] = makeChannel(masks[1]);
+    channels_[2] = makeChannel(masks[0]);
+    channels_[3] = makeChannel(masks[3]);
+
+    if (bits_ == 16) {
+        // Every 16-bit value gets its own entry
+        table_.resize(1 << 16);
+        for (uint32_t value = 0; value < (1u << 16); ++value) {
+            table_[value] = unpackBitfields(value);
+        }
+        decode_row_ = decodeBitfields16;
+    } else {
+        format_ = BMPFile::PixelFormat::BGRA32;
+        decode_row_ = decodeBitfields32;
+    }
+}
+
+BMPDecoder::Channel BMPDecoder::makeChannel(uint32_t mask) {
+    Channel channel;
+    channel.mask = mask;
+    if (mask == 0) return channel;
+
+    channel.shift = __builtin_ctz(mask);
+    const uint32_t bits = mask >> channel.shift;
+    if ((bits & (bits + 1)) != 0) throw std::runtime_error("Invalid BMP color masks");
+
+    // Channels wider than a byte keep their top 8 bits
+    const int width = 32 - __builtin_clz(bits);
+    channel.drop = std::max(0, width - 8);
+    const uint32_t max = bits >> channel.drop;
+    for (uint32_t value = 0; value <= max; ++value) {
+        channel.scale[value] = static_cast<uint8_t>((value * 255 + max / 2) / max);
+    }
+    return channel;
+}
+
+BMPFile::Pixel BMPDecoder::unpackBitfields(uint32_t value) const {
+    uint8_t out[4];
+    for (int c = 0; c < 4; ++c) {
+        const Channel& channel = channels_[c];
+        out[c] = channel.mask ? channel.scale[((value & channel.mask) >> channel.shift) >> channel.drop]
+                              : (c == 3 ? 255 : 0);
+    }
+    return BMPFile::Pixel(out[2], out[1], out[0], out[3]);
+}
+
+void BMPDecoder::decodeIndexed1(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count) {
+    const BMPFile::Pixel* table = decoder.table_.data();
+    const int bytes = count / 8;
+    for (int i = 0; i < bytes; ++i) {
+        std::memcpy(dst + i * 8, table + src[i] * 8, 8 * sizeof(BMPFile::Pixel));
+    }
+    if (count % 8) std::memcpy(dst + bytes * 8, table + src[bytes] * 8, (count % 8) * sizeof(BMPFile::Pixel));
+}
+
+void BMPDecoder::decodeIndexed4(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count) {
+    const BMPFile::Pixel* table = decoder.table_.data();
+    const int bytes = count / 2;
+    for (int i = 0; i < bytes; ++i) {
+        std::memcpy(dst + i * 2, table + src[i] * 2, 2 * sizeof(BMPFile::Pixel));
+    }
+    if (count % 2) dst[count - 1] = table[src[bytes] * 2];
+}
+
+void BMPDecoder::decodeIndexed8(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count) {
+    const BMPFile::Pixel* palette = decoder.palette_.data();
+    for (int i = 0; i < count; ++i) {
+        dst[i] = palette[src[i]];
+    }
+}
+
+void BMPDecoder::decodeBitfields16(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count) {
+    const BMPFile::Pixel* table = decoder.table_.data();
+    for (int i = 0; i < count; ++i) {
+        dst[i] = table[src[i * 2] | (src[i * 2 + 1] << 8)];
+    }
+}
+
+void BMPDecoder::decodeBitfields32(const BMPDecoder& decoder, const uint8_t* src, BMPFile::Pixel* dst, int count) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t value;
+        std::memcpy(&value, src + i * 4, sizeof(value));
+        dst[i] = decoder.unpackBitfields(value);
+    }
+}
+
+uint64_t BMPDecoder::decodeRle(std::istream& file, const BMPFile::RowLayout& layout) const {
+    using Format = BMPFile::PixelFormat;
+    if (layout.format == Format::BGRA32) {
+        return bits_ == 4 ? decodeRleRows<Format::BGRA32, 4>(file, layout)
+                          : decodeRleRows<Format::BGRA32, 8>(file, layout);
+    }
+    return bits_ == 4 ? decodeRleRows<Format::BGR24, 4>(file, layout)
+                      : decodeRleRows<Format::BGR24, 8>(file, layout);
+}
+
+template <BMPFile::PixelFormat Format, int Bits>
+uint64_t BMPDecoder::decodeRleRows(std::istream& file, const BMPFile::RowLayout& layout) const {
+    for (int y = 0; y < height_; ++y) {
+        uint8_t* row = layout.row(y);
+        for (int x = 0; x < width_; ++x) putPixel<Format>(row, x, palette_[0]);
+    }
+
+    // Position in file rows, which run bottom-up
+    RleReader in(file, rle_size_);
+    int x = 0;
+    int y = 0;
+    uint8_t* row = layout.row(height_ - 1);
+
+    while (y < height_ && in.fill(2)) {
+        const int count = in.byte();
+        const int value = in.byte();
+
+        if (count > 0) {
+            // Encoded run: one index repeated, or two alternating 4-bit ones
+            const int end = std::min(x + count, width_);
+            if constexpr (Bits == 8) {
+                const BMPFile::Pixel color = palette_[value];
+                for (int i = x; i < end; ++i) putPixel<Format>(row, i, color);
+            } else {
+                const BMPFile::Pixel colors[2] = {palette_[value >> 4], palette_[value & 15]};
+                for (int i = x; i < end; ++i) putPixel<Format>(row, i, colors[(i - x) & 1]);
+            }
+            x = end;
+            continue;
+        }
+
+        if (value == 0) {
+            // End of line
+            x = 0;
+            if (++y < height_) row = layout.row(height_ - 1 - y);
+        } else if (value == 1) {
+            // End of bitmap
+            break;
+        } else if (value == 2) {
+            // Delta: skip right and up
+            in.require(2);
+            x = std::min(x + in.byte(), width_);
+            y += in.byte();
+            if (y < height_) row = layout.row(height_ - 1 - y);
+        } else {
+            // Absolute run of indices, padded to a 16-bit boundary
+            const size_t bytes = Bits == 8 ? value : (value + 1) / 2;
+            in.require(bytes + (bytes & 1));
+            const uint8_t* indices = in.take(bytes + (bytes & 1));
+            const int end = std::min(x + value, width_);
+            for (int i = x; i < end; ++i) {
+                const int k = i - x;
+                const int index = Bits == 8 ? indices[k] : (k & 1 ? indices[k / 2] & 15 : indices[k / 2] >> 4);
+                putPixel<Format>(row, i, palette_[index]);
+            }
+            x = end;
+        }
+    }
+
+    return in.consumed();
+}
@@ -5,40 +5,160 @@
  */
 
 #include "BMPFile.hpp"
+#include "RowCodec.hpp"
+#include "BMPDecoder.hpp"
+#include "ThresholdKernel.hpp"
+#include "BoxFilterKernel.hpp"
+#include "BitPackKernel.hpp"
+#include "BinaryRaster.hpp"
+#include "Raster/SpanPainter.hpp"
+#include "ThreadPool.hpp"
+#include "Stats.hpp"
 #include <stdexcept>
 #include <cstring>
 #include <algorithm>
+#include <utility>
+
+namespace {
+
+/// Below this size handing rows to the pool costs more than the work
+constexpr long kParallelPixels = 1L << 16;
+
+/// Smallest row chunk handed to a pool task
+constexpr int kMinChunkRows = 16;
+
+/// Bytes of file data converted per read or write call
+constexpr size_t kIoChunkBytes = 1 << 20;
+
+/**
+ * @brief Gets number of rows converted per read or write call
+ * @param row_size Bytes per padded row
+ * @param height Number of rows in the image
+ * @return Row count, at least one
+ */
+int ioChunkRows(size_t row_size, int height) {
+    if (row_size == 0 || height <= 0) return 1;
+    return static_cast<int>(std::clamp<size_t>(kIoChunkBytes / row_size, 1, height));
+}
+
+/**
+ * @brief Runs fn(first, end) over rows [first_row, end_row)
+ * @param first_row First row
+ * @param end_row Row after the last one
+ * @param parallel Split rows into chunks on the shared pool
+ * @param fn Callable processing a row range
+ * @param min_chunk Smallest range handed to a pool task
+ */
+template <typename Fn>
+void forRowChunks(int first_row, int end_row, bool parallel, Fn&& fn, int min_chunk = kMinChunkRows) {
+    if (parallel) {
+        ThreadPool::shared().parallelFor(first_row, end_row, min_chunk, fn);
+    } else if (first_row < end_row) {
+        fn(first_row, end_row);
+    }
+}
+
+/**
+ * @brief Gets the calling thread's scratch row
+ * @param pixels Number of pixels needed
+ * @return Row of at least that many pixels, valid until the next call on this thread
+ *
+ * Rows only grow and live as long as the thread, so pool workers stop
+ * acquiring scratch buffers once they have seen the widest image.
+ */
+BMPFile::Pixel* scratchRow(size_t pixels) {
+    thread_local PooledVector<BMPFile::Pixel> row;
+    if (row.size() < pixels) row.resize(pixels);
+    return row.data();
+}
+
+/**
+ * @brief Gets the highest level among requested mip outputs
+ * @param mips Requested outputs
+ * @return Deepest level, 0 if none
+ * @throws std::invalid_argument if a level is below 1
+ */
+int deepestMip(const std::vector<BMPFile::MipOutput>& mips) {
+    int levels = 0;
+    for (const BMPFile::MipOutput& mip : mips) {
+        if (mip.level < 1) throw std::invalid_argument("Pyramid level out of range");
+        levels = std::max(levels, mip.level);
+    }
+    return levels;
+}
+
+/**
+ * @brief Calls fn with the overwriting painter for a row layout
+ * @param layout Rows to paint
+ * @param color Fill color, stored as is whatever its alpha
+ * @param fn Callable invoked once as fn(painter)
+ */
+template <typename Fn>
+void withFillPainter(const BMPFile::RowLayout& layout, BMPFile::Pixel color, Fn&& fn) {
+    using Format = BMPFile::PixelFormat;
+    if (layout.format == Format::BGRA32) fn(SpanPainter<Format::BGRA32, false>(layout, color));
+    else fn(SpanPainter<Format::BGR24, false>(layout, color));
+}
+
+} // namespace
+
+BMPFile::BMPFile(BMPFile&& other) noexcept
+    : bmp_header_(std::exchange(other.bmp_header_, BMPHeader())),
+      dib_header_(std::exchange(other.dib_header_, DIBHeader())),
+      pixels_(std::move(other.pixels_)),
+      packed_(std::move(other.packed_)),
+      mapping_(std::move(other.mapping_)),
+      storage_(std::exchange(other.storage_, Storage::Unpacked)) {}
+
+BMPFile& BMPFile::operator=(BMPFile&& other) noexcept {
+    if (this != &other) {
+        bmp_header_ = std::exchange(other.bmp_header_, BMPHeader());
+        dib_header_ = std::exchange(other.dib_header_, DIBHeader());
+        pixels_ = std::move(other.pixels_);
+        packed_ = std::move(other.packed_);
+        mapping_ = std::move(other.mapping_);
+        storage_ = std::exchange(other.storage_, Storage::Unpacked);
+    }
+    return *this;
+}
 
 /**
  * @brief Loads BMP image from file
  * @param filename Path to BMP file
+ * @param storage Pixel storage to load into
  * @return true if file loaded successfully, false on error
  * @throws std::runtime_error on invalid file format or unsupported BMP type
  */
-bool BMPFile::load(const std::string& filename) {
+bool BMPFile::load(const std::string& filename, Storage storage) {
+    // Whatever fails below, the image is left empty rather than half loaded
+    reset();
+
     std::ifstream file(filename, std::ios::binary);
     if (!file) return false;
 
+    uint64_t bytes_read = 0;
     try {
         readHeaders(file);
-
-        // Check "BM" signature
-        if (bmp_header_.signature != 0x4D42)
-            throw std::runtime_error("Not a BMP file");
-
-        // Only support 24 and 32 bits per pixel
-        if (dib_header_.bits_per_pixel != 24 && dib_header_.bits_per_pixel != 32)
-            throw std::runtime_error("Only 24/32-bit BMP supported");
-
-        // Don't support compressed BMP
-        if (dib_header_.compression != 0)
-            throw std::runtime_error("Compressed BMP not supported");
-
-        readPixels(file);
-    } catch (const std::exception& e) {
+        if (!BMPDecoder::isNative(dib_header_)) {
+            bytes_read = readDecodedPixels(file, storage);
+        } else {
+            validateHeaders(bmp_header_, dib_header_);
+            if (width() <= 0 || height() <= 0)
+                throw std::runtime_error("Invalid image dimensions");
+            if (storage == Storage::Native) {
+                readPackedPixels(file);
+            } else {
+                readPixels(file);
+            }
+            storage_ = storage;
+            bytes_read = sizeof(BMPHeader) + sizeof(DIBHeader) + getRowSize() * height();
+        }
+    } catch (const std::exception&) {
+        reset();
         return false;
     }
 
+    Stats::add(Stats::Counter::BytesRead, bytes_read);
     return true;
 }
 
@@ -51,6 +171,144 @@ void BMPFile::readHeaders(std::ifstream& file) {
     file.read(reinterpret_cast<char*>(&dib_header_), sizeof(DIBHeader));
 }
 
+/**
+ * @brief Checks that headers describe a BMP with uncompressed 24/32-bit rows
+ * @param bmp_header File header
+ * @param dib_header Information header
+ * @throws std::runtime_error on unsupported or malformed headers
+ */
+void BMPFile::validateHeaders(const BMPHeader& bmp_header, const DIBHeader& dib_header) {
+    // Check "BM" signature
+    if (bmp_header.signature != 0x4D42)
+        throw std::runtime_error("Not a BMP file");
+
+    // Only support 24 and 32 bits per pixel
+    if (dib_header.bits_per_pixel != 24 && dib_header.bits_per_pixel != 32)
+        throw std::runtime_error("Only 24/32-bit BMP supported");
+
+    // Don't support compressed BMP
+    if (dib_header.compression != 0)
+        throw std::runtime_error("Compressed BMP not supported");
+}
+
+/**
+ * @brief Maps BMP image from file without copying pixel data
+ * @param filename Path to BMP file
+ * @param mode Mapping access mode
+ * @return true if file mapped successfully, false on error
+ */
+bool BMPFile::mapFile(const std::string& filename, MapMode mode) {
+    // Whatever fails below, the image is left empty rather than half mapped
+    reset();
+
+    MappedFile mapping;
+    if (!mapping.open(filename, mode)) return false;
+
+    const size_t headers_size = sizeof(BMPHeader) + sizeof(DIBHeader);
+    if (mapping.size() < headers_size) return false;
+
+    std::memcpy(&bmp_header_, mapping.data(), sizeof(BMPHeader));
+    std::memcpy(&dib_header_, mapping.data() + sizeof(BMPHeader), sizeof(DIBHeader));
+
+    // Rows that need decoding cannot be served from the mapping
+    if (!BMPDecoder::isNative(dib_header_)) return load(filename, Storage::Native);
+
+    try {
+        validateHeaders(bmp_header_, dib_header_);
+
+        if (width() <= 0 || height() <= 0)
+            throw std::runtime_error("Invalid image dimensions");
+
+        // Every row must lie inside the mapping
+        const uint64_t pixel_bytes = static_cast<uint64_t>(getRowSize()) * height();
+        if (bmp_header_.data_offset > mapping.size() ||
+            pixel_bytes > mapping.size() - bmp_header_.data_offset)
+            throw std::runtime_error("Truncated BMP file");
+    } catch (const std::exception&) {
+        reset();
+        return false;
+    }
+
+    mapping_ = std::move(mapping);
+    storage_ = Storage::Native;
+    Stats::add(Stats::Counter::BytesRead, mapping_.size());
+    return true;
+}
+
+/**
+ * @brief Makes the image an empty 0x0 image
+ */
+void BMPFile::reset() {
+    releasePixels();
+    bmp_header_ = BMPHeader();
+    dib_header_ = DIBHeader();
+}
+
+/**
+ * @brief Releases all pixel storage
+ */
+void BMPFile::releasePixels() {
+    pixels_.clear();
+    pixels_.shrink_to_fit();
+    packed_.clear();
+    packed_.shrink_to_fit();
+    mapping_.close();
+    storage_ = Storage::Unpacked;
+}
+
+/**
+ * @brief Gets start of the native pixel block
+ * @return Pointer to the first row in file order
+ */
+uint8_t* BMPFile::nativeBase() {
+    return isMapped() ? mapping_.data() + bmp_header_.data_offset : packed_.data();
+}
+
+const uint8_t* BMPFile::nativeBase() const {
+    return isMapped() ? mapping_.data() + bmp_header_.data_offset : packed_.data();
+}
+
+/**
+ * @brief Gets raw on-disk bytes of a natively stored row
+ * @param y Y coordinate (0 to height-1)
+ * @return Pointer to the row inside the native pixel block
+ * @throws std::logic_error if storage is not Native or is mapped read-only
+ */
+uint8_t* BMPFile::rowData(int y) {
+    if (storage_ != Storage::Native) throw std::logic_error("Image is not stored natively");
+    if (isMapped() && !mapping_.isWritable()) throw std::logic_error("Image is mapped read-only");
+    return nativeBase() + rowIndex(y) * getRowSize();
+}
+
+/**
+ * @brief Gets raw on-disk bytes of a natively stored row
+ * @param y Y coordinate (0 to height-1)
+ * @return Pointer to the row inside the native pixel block
+ * @throws std::logic_error if storage is not Native
+ */
+const uint8_t* BMPFile::rowData(int y) const {
+    if (storage_ != Storage::Native) throw std::logic_error("Image is not stored natively");
+    return nativeBase() + rowIndex(y) * getRowSize();
+}
+
+/**
+ * @brief Gets row addressing that works for every storage
+ * @return Origin, stride and pixel layout of the stored rows
+ * @throws std::logic_error if the image is mapped read-only
+ */
+BMPFile::RowLayout BMPFile::rowLayout() {
+    if (storage_ == Storage::Unpacked) {
+        return {reinterpret_cast<uint8_t*>(pixels_.data()), static_cast<ptrdiff_t>(width() * sizeof(Pixel)),
+                PixelFormat::BGRA32};
+    }
+
+    if (isMapped() && !mapping_.isWritable()) throw std::logic_error("Image is mapped read-only");
+    const ptrdiff_t row_size = static_cast<ptrdiff_t>(getRowSize());
+    const bool bottom_up = dib_header_.height > 0;
+    uint8_t* origin = nativeBase() + (bottom_up ? std::max(0, height() - 1) * row_size : 0);
+    return {origin, bottom_up ? -row_size : row_size, format()};
+}
+
 /**
  * @brief Reads pixel data from file
  * @param file Open file stream positioned at start of pixel data
@@ -62,30 +320,109 @@ void BMPFile::readPixels(std::ifstream& file) {
     const int h = height();
     pixels_.resize(w * h);
 
+    // Rows are read in large chunks and decoded in parallel
     const size_t row_size = getRowSize();
-    std::vector<uint8_t> row(row_size);
+    const int chunk_rows = ioChunkRows(row_size, h);
+    PooledVector<uint8_t> chunk(chunk_rows * row_size);
+    const RowCodec::DecodeFn decode = RowCodec::get().decoder(format());
+    const bool parallel = static_cast<long>(w) * h >= kParallelPixels;
 
-    for (int y = 0; y < h; ++y) {
-        file.read(reinterpret_cast<char*>(row.data()), row_size);
+    for (int y0 = 0; y0 < h; y0 += chunk_rows) {
+        const int rows = std::min(chunk_rows, h - y0);
+        file.read(reinterpret_cast<char*>(chunk.data()), rows * row_size);
+        if (!file) throw std::runtime_error("Truncated BMP file");
+        forRowChunks(0, rows, parallel, [&](int first, int end) {
+            for (int i = first; i < end; ++i) {
+                decode(chunk.data() + i * row_size, &pixels_[index(0, rowIndex(y0 + i))], w);
+            }
+        });
+    }
+}
 
-        for (int x = 0; x < w; ++x) {
-            size_t pos = x * (is32bit() ? 4 : 3);
-            Pixel& p = pixels_[index(x, rowIndex(y))];
+/**
+ * @brief Decodes palettized, bitfield or RLE pixel data
+ * @param file File stream
+ * @param storage Pixel storage to decode into
+ * @return Bytes of the file consumed
+ * @throws std::runtime_error on unsupported, malformed or truncated data
+ */
+uint64_t BMPFile::readDecodedPixels(std::ifstream& file, Storage storage) {
+    const BMPDecoder decoder(file, bmp_header_, dib_header_);
+    const uint32_t data_offset = bmp_header_.data_offset;
 
-            p.b = row[pos];
-            p.g = row[pos + 1];
-            p.r = row[pos + 2];
-            if (is32bit()) p.a = row[pos + 3];
-        }
+    // From here on the headers describe the decoded 24/32-bit image
+    dib_header_.header_size = sizeof(DIBHeader);
+    dib_header_.bits_per_pixel = decoder.format() == PixelFormat::BGRA32 ? 32 : 24;
+    dib_header_.compression = 0;
+    dib_header_.image_size = static_cast<uint32_t>(getRowSize() * height());
+    dib_header_.colors_used = 0;
+    dib_header_.important_colors = 0;
+    bmp_header_.data_offset = sizeof(BMPHeader) + sizeof(DIBHeader);
+    bmp_header_.file_size = bmp_header_.data_offset + dib_header_.image_size;
+
+    const int w = width();
+    const int h = height();
+    const size_t row_size = getRowSize();
+    const bool native = storage == Storage::Native;
+    if (native) {
+        packed_.assign(row_size * h, 0);
+    } else {
+        pixels_.resize(static_cast<size_t>(w) * h);
     }
+    storage_ = storage;
+
+    file.clear();
+    file.seekg(data_offset, std::ios::beg);
+
+    // RLE runs are decoded straight into the rows of either storage
+    if (decoder.isRle()) return data_offset + decoder.decodeRle(file, rowLayout());
+
+    // Stored rows are read in large chunks and expanded in parallel
+    const size_t stored_row_size = decoder.storedRowSize();
+    const int chunk_rows = ioChunkRows(stored_row_size, h);
+    PooledVector<uint8_t> chunk(chunk_rows * stored_row_size);
+    const RowCodec::EncodeFn encode = RowCodec::get().encoder(format());
+    const bool parallel = static_cast<long>(w) * h >= kParallelPixels;
+
+    for (int y0 = 0; y0 < h; y0 += chunk_rows) {
+        const int rows = std::min(chunk_rows, h - y0);
+        file.read(reinterpret_cast<char*>(chunk.data()), rows * stored_row_size);
+        if (!file) throw std::runtime_error("Truncated BMP file");
+        forRowChunks(0, rows, parallel, [&](int first, int end) {
+            Pixel* scratch = native ? scratchRow(w) : nullptr;
+            for (int i = first; i < end; ++i) {
+                Pixel* dst = native ? scratch : &pixels_[index(0, rowIndex(y0 + i))];
+                decoder.decodeRow(chunk.data() + i * stored_row_size, dst, w);
+                if (native) encode(dst, packed_.data() + (y0 + i) * row_size, w);
+            }
+        });
+    }
+    return data_offset + static_cast<uint64_t>(stored_row_size) * h;
+}
+
+/**
+ * @brief Reads pixel block from file into native storage
+ * @param file Open file stream
+ * @throws std::runtime_error if the file is truncated
+ */
+void BMPFile::readPackedPixels(std::ifstream& file) {
+    file.seekg(bmp_header_.data_offset, std::ios::beg);
+
+    packed_.resize(getRowSize() * height());
+    file.read(reinterpret_cast<char*>(packed_.data()), packed_.size());
+    if (!file) throw std::runtime_error("Truncated BMP file");
 }
 
 /**
  * @brief Saves BMP image to file
  * @param filename Path to save file
+ * @param mips Pyramid levels to write as separate files
  * @return true if file saved successfully, false on error
+ * @throws std::invalid_argument if a mip level is out of range
  */
-bool BMPFile::save(const std::string& filename) const {
+bool BMPFile::save(const std::string& filename, const std::vector<MipOutput>& mips) const {
+    const Pyramid pyramid = createPyramid(deepestMip(mips));
+
     std::ofstream file(filename, std::ios::binary);
     if (!file) return false;
 
@@ -95,27 +432,344 @@ bool BMPFile::save(const std::string& filename) const {
         const int w = width();
         const int h = height();
         const size_t row_size = getRowSize();
-        std::vector<uint8_t> row(row_size, 0);
+        const bool parallel = static_cast<long>(w) * h >= kParallelPixels;
+
+        // Native rows are already in file order and layout
+        if (storage_ == Storage::Native) {
+            file.write(reinterpret_cast<const char*>(nativeBase()), row_size * h);
+            // Small files may still be buffered, and a failed write there would go unnoticed
+            if (!file.flush()) return false;
+            Stats::add(Stats::Counter::BytesWritten, sizeof(BMPHeader) + sizeof(DIBHeader) + row_size * h);
+            downsampleFileRows(pyramid, 0, h, parallel);
+            return saveMips(pyramid, mips);
+        }
 
-        for (int y = 0; y < h; ++y) {
-            for (int x = 0; x < w; ++x) {
-                const Pixel& p = pixels_[index(x, rowIndex(y))];
-                size_t pos = x * (is32bit() ? 4 : 3);
+        // Rows are encoded in parallel and written in large chunks
+        const int chunk_rows = ioChunkRows(row_size, h);
+        PooledVector<uint8_t> chunk(chunk_rows * row_size, 0);
+        const RowCodec::EncodeFn encode = RowCodec::get().encoder(format());
 
-                row[pos] = p.b;
-                row[pos + 1] = p.g;
-                row[pos + 2] = p.r;
-                if (is32bit()) row[pos + 3] = p.a;
-            }
-            file.write(reinterpret_cast<char*>(row.data()), row_size);
+        for (int y0 = 0; y0 < h; y0 += chunk_rows) {
+            const int rows = std::min(chunk_rows, h - y0);
+            forRowChunks(0, rows, parallel, [&](int first, int end) {
+                for (int i = first; i < end; ++i) {
+                    encode(&pixels_[index(0, rowIndex(y0 + i))], chunk.data() + i * row_size, w);
+                }
+            });
+            file.write(reinterpret_cast<char*>(chunk.data()), rows * row_size);
+            downsampleFileRows(pyramid, y0, y0 + rows, parallel);
+        }
+        if (!file.flush()) return false;
+        Stats::add(Stats::Counter::BytesWritten, sizeof(BMPHeader) + sizeof(DIBHeader) + row_size * h);
+    } catch (...) {
+        return false;
+    }
+
+    return saveMips(pyramid, mips);
+}
+
+/**
+ * @brief Builds the headers of a 1-bit black and white file
+ * @param width Image width in pixels
+ * @param height Image height in pixels, negative for top-down rows
+ * @param bmp_header Receives the file header
+ * @param dib_header Receives the information header
+ */
+void BMPFile::monochromeHeaders(int width, int32_t height, BMPHeader& bmp_header, DIBHeader& dib_header) {
+    dib_header = DIBHeader();
+    dib_header.width = width;
+    dib_header.height = height;
+    dib_header.bits_per_pixel = 1;
+    dib_header.image_size = static_cast<uint32_t>(monochromeRowSize(width) * std::abs(height));
+    dib_header.colors_used = 2;
+    dib_header.important_colors = 2;
+
+    bmp_header = BMPHeader();
+    bmp_header.data_offset = sizeof(BMPHeader) + sizeof(DIBHeader) + sizeof(kMonoPalette);
+    bmp_header.file_size = bmp_header.data_offset + dib_header.image_size;
+}
+
+/**
+ * @brief Saves a black and white image as a 1-bit palettized BMP
+ * @param filename Path to save file
+ * @param mips Pyramid levels to write as separate files
+ * @return true if file saved successfully, false on error
+ * @throws std::invalid_argument if a mip level is out of range
+ */
+bool BMPFile::saveMonochrome(const std::string& filename, const std::vector<MipOutput>& mips) const {
+    const Pyramid pyramid = createPyramid(deepestMip(mips));
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) return false;
+
+    try {
+        const int w = width();
+        const int h = height();
+        const size_t row_size = monochromeRowSize(w);
+        const size_t packed_bytes = (static_cast<size_t>(w) + 7) / 8;
+        const bool parallel = static_cast<long>(w) * h >= kParallelPixels;
+
+        BMPHeader bmp;
+        DIBHeader dib;
+        monochromeHeaders(w, dib_header_.height, bmp, dib);
+        dib.x_pixels_per_meter = dib_header_.x_pixels_per_meter;
+        dib.y_pixels_per_meter = dib_header_.y_pixels_per_meter;
+
+        file.write(reinterpret_cast<const char*>(&bmp), sizeof(BMPHeader));
+        file.write(reinterpret_cast<const char*>(&dib), sizeof(DIBHeader));
+        file.write(reinterpret_cast<const char*>(kMonoPalette), sizeof(kMonoPalette));
+
+        // Rows are packed in parallel and written in large chunks; native
+        // rows are expanded to pixels first so the same kernel packs both
+        const int chunk_rows = ioChunkRows(row_size, h);
+        PooledVector<uint8_t> chunk(chunk_rows * row_size, 0);
+        const BitPackKernel& kernel = BitPackKernel::get();
+        const RowCodec::DecodeFn decode = RowCodec::get().decoder(format());
+        const bool native = storage_ == Storage::Native;
+
+        for (int y0 = 0; y0 < h; y0 += chunk_rows) {
+            const int rows = std::min(chunk_rows, h - y0);
+            forRowChunks(0, rows, parallel, [&](int first, int end) {
+                Pixel* scratch = native ? scratchRow(w) : nullptr;
+                for (int i = first; i < end; ++i) {
+                    const int y = rowIndex(y0 + i);
+                    const Pixel* src = scratch;
+                    if (native) {
+                        decode(rowData(y), scratch, w);
+                    } else {
+                        src = &pixels_[index(0, y)];
+                    }
+                    uint8_t* dst = chunk.data() + i * row_size;
+                    kernel.pack(src, dst, w);
+                    std::memset(dst + packed_bytes, 0, row_size - packed_bytes);
+                }
+            });
+            file.write(reinterpret_cast<char*>(chunk.data()), rows * row_size);
+            downsampleFileRows(pyramid, y0, y0 + rows, parallel);
         }
+        if (!file.flush()) return false;
+        Stats::add(Stats::Counter::BytesWritten, bmp.file_size);
     } catch (...) {
         return false;
     }
 
+    return saveMips(pyramid, mips);
+}
+
+/**
+ * @brief Saves BMP image through the background writer
+ * @param filename Path to save file
+ * @param options Buffering and I/O settings of the writer
+ * @param mips Pyramid levels to write as separate files
+ * @return true if file saved successfully, false on error
+ * @throws std::invalid_argument if a mip level is out of range
+ */
+bool BMPFile::saveAsync(const std::string& filename, const AsyncFileWriter::Options& options,
+                        const std::vector<MipOutput>& mips) const {
+    const Pyramid pyramid = createPyramid(deepestMip(mips));
+    const int w = width();
+    const int h = height();
+    const size_t row_size = getRowSize();
+    const size_t pixel_bytes = row_size * h;
+    const bool parallel = static_cast<long>(w) * h >= kParallelPixels;
+
+    AsyncFileWriter writer;
+    if (!writer.open(filename, options, sizeof(BMPHeader) + sizeof(DIBHeader) + pixel_bytes)) return false;
+
+    writer.write(&bmp_header_, sizeof(BMPHeader));
+    writer.write(&dib_header_, sizeof(DIBHeader));
+
+    // Native rows are already in file order and layout
+    if (storage_ == Storage::Native) {
+        writer.write(nativeBase(), pixel_bytes);
+        downsampleFileRows(pyramid, 0, h, parallel);
+        if (!writer.close()) return false;
+        Stats::add(Stats::Counter::BytesWritten, sizeof(BMPHeader) + sizeof(DIBHeader) + pixel_bytes);
+        return saveMips(pyramid, mips);
+    }
+
+    const RowCodec::EncodeFn encode = RowCodec::get().encoder(format());
+    PooledVector<uint8_t> scratch;
+
+    for (int y0 = 0; y0 < h;) {
+        // Encode as many whole rows as fit in the current buffer in place
+        const int rows = static_cast<int>(std::min<size_t>(writer.available() / row_size, h - y0));
+        if (rows == 0) {
+            // A row straddling two buffers goes through a scratch row
+            scratch.resize(row_size);
+            encode(&pixels_[index(0, rowIndex(y0))], scratch.data(), w);
+            writer.write(scratch.data(), row_size);
+            downsampleFileRows(pyramid, y0, y0 + 1, parallel);
+            ++y0;
+            continue;
+        }
+
+        // Buffers are reused, so row padding is cleared explicitly
+        uint8_t* dst = writer.reserve(rows * row_size);
+        const size_t padding = row_size - static_cast<size_t>(w) * bytesPerPixel();
+        forRowChunks(0, rows, parallel, [&](int first, int end) {
+            for (int i = first; i < end; ++i) {
+                uint8_t* row = dst + i * row_size;
+                encode(&pixels_[index(0, rowIndex(y0 + i))], row, w);
+                std::memset(row + row_size - padding, 0, padding);
+            }
+        });
+        writer.commit(rows * row_size);
+        downsampleFileRows(pyramid, y0, y0 + rows, parallel);
+        y0 += rows;
+    }
+
+    if (!writer.close()) return false;
+    Stats::add(Stats::Counter::BytesWritten, sizeof(BMPHeader) + sizeof(DIBHeader) + pixel_bytes);
+    return saveMips(pyramid, mips);
+}
+
+/**
+ * @brief Builds a mip pyramid of the image
+ * @param levels Number of levels below the full image
+ * @return Levels from half size down
+ * @throws std::invalid_argument if levels is out of range
+ */
+BMPFile::Pyramid BMPFile::buildPyramid(int levels) const {
+    Pyramid pyramid = createPyramid(levels);
+    if (!pyramid.empty()) {
+        const int group_rows = 1 << levels;
+        downsampleGroups(pyramid, 0, (height() + group_rows - 1) / group_rows,
+                         static_cast<long>(width()) * height() >= kParallelPixels);
+    }
+    return pyramid;
+}
+
+/**
+ * @brief Gets the deepest pyramid level with whole pixels
+ * @return Number of times both sides can be halved
+ */
+int BMPFile::maxPyramidLevels() const {
+    int levels = 0;
+    for (int side = std::min(width(), height()); side > 1; side >>= 1) ++levels;
+    return levels;
+}
+
+/**
+ * @brief Allocates blank pyramid levels
+ * @param levels Number of levels
+ * @return Unpacked top-down images in the image's format
+ * @throws std::invalid_argument if levels is out of range
+ */
+BMPFile::Pyramid BMPFile::createPyramid(int levels) const {
+    if (levels < 0 || levels > maxPyramidLevels())
+        throw std::invalid_argument("Pyramid level out of range");
+
+    Pyramid pyramid;
+    for (int k = 1; k <= levels; ++k) {
+        pyramid.push_back(std::make_unique<BMPFile>());
+        pyramid.back()->create(width() >> k, height() >> k, format(), Pixel{});
+    }
+    return pyramid;
+}
+
+/**
+ * @brief Fills pyramid rows under groups of source rows
+ * @param pyramid Pyramid levels
+ * @param first_group First group of 2^levels source rows
+ * @param end_group Group after the last one (the last group may be partial)
+ * @param parallel Split groups across threads
+ */
+void BMPFile::downsampleGroups(const Pyramid& pyramid, int first_group, int end_group, bool parallel) const {
+    const int levels = static_cast<int>(pyramid.size());
+    if (levels == 0) return;
+
+    const BoxFilterKernel& kernel = BoxFilterKernel::get();
+    const RowCodec::DecodeFn decode = RowCodec::get().decoder(format());
+    const bool native = storage_ == Storage::Native;
+    const int w = width();
+
+    // A group covers the same rows on every level, so groups are independent;
+    // only the last one may be cut short by the image height
+    forRowChunks(first_group, end_group, parallel, [&](int first, int end) {
+        Pixel* scratch = native ? scratchRow(2 * static_cast<size_t>(w)) : nullptr;
+        for (int group = first; group < end; ++group) {
+            for (int k = 1; k <= levels; ++k) {
+                BMPFile& dst = *pyramid[k - 1];
+                const int rows = 1 << (levels - k);
+                const int end_y = std::min((group + 1) * rows, dst.height());
+                for (int y = group * rows; y < end_y; ++y) {
+                    const Pixel* upper;
+                    const Pixel* lower;
+                    if (k > 1) {
+                        upper = pyramid[k - 2]->row(2 * y);
+                        lower = pyramid[k - 2]->row(2 * y + 1);
+                    } else if (native) {
+                        decode(rowData(2 * y), scratch, w);
+                        decode(rowData(2 * y + 1), scratch + w, w);
+                        upper = scratch;
+                        lower = scratch + w;
+                    } else {
+                        upper = &pixels_[index(0, 2 * y)];
+                        lower = &pixels_[index(0, 2 * y + 1)];
+                    }
+                    kernel.apply(upper, lower, dst.row(y), dst.width());
+                }
+            }
+        }
+    }, std::max(1, kMinChunkRows >> levels));
+}
+
+/**
+ * @brief Fills pyramid rows completed by newly encoded file rows
+ * @param pyramid Pyramid levels
+ * @param done_rows File rows encoded before
+ * @param end_row File rows encoded now
+ * @param parallel Split groups across threads
+ */
+void BMPFile::downsampleFileRows(const Pyramid& pyramid, int done_rows, int end_row, bool parallel) const {
+    const int levels = static_cast<int>(pyramid.size());
+    if (levels == 0) return;
+
+    const int h = height();
+    const int group_rows = 1 << levels;
+    const int groups = (h + group_rows - 1) / group_rows;
+
+    // Groups lying entirely inside the first `rows` file rows
+    auto finished = [&](int rows) -> std::pair<int, int> {
+        if (dib_header_.height < 0) return {0, rows == h ? groups : rows / group_rows};
+        return {(h - rows + group_rows - 1) / group_rows, groups};
+    };
+
+    const auto [before_first, before_end] = finished(done_rows);
+    const auto [after_first, after_end] = finished(end_row);
+    downsampleGroups(pyramid, after_first, before_first, parallel);
+    downsampleGroups(pyramid, before_end, after_end, parallel);
+}
+
+/**
+ * @brief Saves requested pyramid levels
+ * @param pyramid Pyramid levels
+ * @param mips Levels to write
+ * @return true if every level was saved
+ */
+bool BMPFile::saveMips(const Pyramid& pyramid, const std::vector<MipOutput>& mips) {
+    for (const MipOutput& mip : mips) {
+        if (!pyramid[mip.level - 1]->save(mip.filename)) return false;
+    }
     return true;
 }
 
+/**
+ * @brief Converts one row to its on-disk layout
+ * @param y Y coordinate (0 to height-1)
+ * @param dst Destination of at least one padded row
+ * @throws std::out_of_range if y is out of bounds
+ */
+void BMPFile::encodeRow(int y, uint8_t* dst) const {
+    if (!inBounds(0, y)) throw std::out_of_range("Row out of range");
+    if (storage_ == Storage::Native) {
+        std::memcpy(dst, rowData(y), getRowSize());
+        return;
+    }
+    RowCodec::get().encode(format(), &pixels_[index(0, y)], dst, width());
+}
+
 /**
  * @brief Writes BMP headers to file
  * @param file File stream for writing
@@ -134,6 +788,10 @@ void BMPFile::writeHeaders(std::ofstream& file) const {
  */
 BMPFile::Pixel BMPFile::getPixel(int x, int y) const {
     if (!inBounds(x, y)) throw std::out_of_range("Pixel out of range");
+    if (storage_ == Storage::Native) {
+        const uint8_t* p = rowData(y) + x * bytesPerPixel();
+        return {p[2], p[1], p[0], is32bit() ? p[3] : uint8_t(255)};
+    }
     return pixels_[index(x, y)];
 }
 
@@ -146,13 +804,80 @@ BMPFile::Pixel BMPFile::getPixel(int x, int y) const {
  */
 void BMPFile::setPixel(int x, int y, Pixel pixel) {
     if (!inBounds(x, y)) throw std::out_of_range("Pixel out of range");
+    if (storage_ == Storage::Native) {
+        uint8_t* p = rowData(y) + x * bytesPerPixel();
+        p[0] = pixel.b;
+        p[1] = pixel.g;
+        p[2] = pixel.r;
+        if (is32bit()) p[3] = pixel.a;
+        return;
+    }
     pixels_[index(x, y)] = pixel;
 }
 
+/**
+ * @brief Gets unchecked pointer to an unpacked row
+ * @param y Y coordinate (0 to height-1)
+ * @return First pixel of the row
+ * @throws std::logic_error if storage is not Unpacked
+ */
+BMPFile::Pixel* BMPFile::row(int y) {
+    if (storage_ != Storage::Unpacked) throw std::logic_error("Image is not stored unpacked");
+    return pixels_.data() + index(0, y);
+}
+
+const BMPFile::Pixel* BMPFile::row(int y) const {
+    if (storage_ != Storage::Unpacked) throw std::logic_error("Image is not stored unpacked");
+    return pixels_.data() + index(0, y);
+}
+
+/**
+ * @brief Fills pixels [x0, x1] of a row with a color
+ * @param y Y coordinate (pre-clipped)
+ * @param x0 First X coordinate (pre-clipped)
+ * @param x1 Last X coordinate, inclusive (pre-clipped)
+ * @param color Fill color
+ */
+void BMPFile::fillSpan(int y, int x0, int x1, Pixel color) {
+    withFillPainter(rowLayout(), color, [&](const auto& paint) { paint(y, x0, x1); });
+}
+
+/**
+ * @brief Composites a color over part of a row
+ * @param y Y coordinate (pre-clipped)
+ * @param x0 First X coordinate (pre-clipped)
+ * @param x1 Last X coordinate, inclusive (pre-clipped)
+ * @param color Color with straight alpha
+ */
+void BMPFile::blendSpan(int y, int x0, int x1, Pixel color) {
+    if (color.a == 0) return;
+    withSpanPainter(rowLayout(), color, [&](const auto& paint) { paint(y, x0, x1); });
+}
+
+/**
+ * @brief Fills a rectangle with a color
+ * @param x0 Left X coordinate (pre-clipped)
+ * @param y0 Top Y coordinate (pre-clipped)
+ * @param x1 Right X coordinate, inclusive (pre-clipped)
+ * @param y1 Bottom Y coordinate, inclusive (pre-clipped)
+ * @param color Fill color
+ */
+void BMPFile::fillRect(int x0, int y0, int x1, int y1, Pixel color) {
+    withFillPainter(rowLayout(), color, [&](const auto& paint) {
+        for (int y = y0; y <= y1; ++y) paint(y, x0, x1);
+    });
+}
+
 /**
  * @brief Flips image vertically
  */
 void BMPFile::flipVertically() {
+    // Native rows are addressed through the header orientation
+    if (storage_ == Storage::Native) {
+        dib_header_.height = -dib_header_.height;
+        return;
+    }
+
     const int w = width();
     const int h = height();
     for (int y = 0; y < h / 2; ++y) {
@@ -167,14 +892,99 @@ void BMPFile::flipVertically() {
  * @brief Converts image to black and white
  */
 void BMPFile::convertToBlackAndWhite() {
-    for (Pixel& p : pixels_) {
-        uint8_t brightness = static_cast<uint8_t>(0.299 * p.r + 0.587 * p.g + 0.114 * p.b);
-        if (brightness > 127) {
-            p = {255, 255, 255, p.a}; // white
-        } else {
-            p = {0, 0, 0, p.a}; // black
+    convertToBlackAndWhite(ThresholdKernel::get());
+}
+
+/**
+ * @brief Converts image to black and white with a specific kernel
+ * @param kernel Threshold kernel to run on every row
+ * @throws std::logic_error if the image is mapped read-only
+ */
+void BMPFile::convertToBlackAndWhite(const ThresholdKernel& kernel) {
+    const bool parallel = static_cast<long>(width()) * height() >= kParallelPixels;
+    thresholdRows(kernel, 0, height(), parallel);
+}
+
+/**
+ * @brief Thresholds the image into a bit-packed raster
+ * @param out Raster to fill
+ */
+void BMPFile::convertToBlackAndWhite(BinaryRaster& out) const {
+    const int w = width();
+    const int h = height();
+    const bool parallel = static_cast<long>(w) * h >= kParallelPixels;
+    out.create(w, h, false, dib_header_.height < 0);
+
+    const ThresholdKernel& threshold = ThresholdKernel::get();
+    const BitPackKernel& pack = BitPackKernel::get();
+    const RowCodec::DecodeFn decode = RowCodec::get().decoder(format());
+    const bool native = storage_ == Storage::Native;
+
+    forRowChunks(0, h, parallel, [&](int first, int end) {
+        Pixel* scratch = scratchRow(w);
+        for (int y = first; y < end; ++y) {
+            if (native) {
+                decode(rowData(y), scratch, w);
+            } else {
+                std::copy_n(&pixels_[index(0, y)], w, scratch);
+            }
+            threshold.apply(scratch, w);
+            pack.pack(scratch, reinterpret_cast<uint8_t*>(out.row(y)), w);
         }
+    });
+}
+
+/**
+ * @brief Converts a range of rows to black and white on the calling thread
+ * @param first_row First row to convert
+ * @param rows Number of rows
+ * @throws std::out_of_range if the range exceeds the image
+ * @throws std::logic_error if the image is mapped read-only
+ */
+void BMPFile::convertRowsToBlackAndWhite(int first_row, int rows) {
+    if (first_row < 0 || rows < 0 || first_row + rows > height())
+        throw std::out_of_range("Row range out of range");
+    thresholdRows(ThresholdKernel::get(), first_row, first_row + rows, false);
+}
+
+/**
+ * @brief Thresholds rows [first_row, end_row)
+ * @param kernel Threshold kernel
+ * @param first_row First row to convert
+ * @param end_row Row after the last one to convert
+ * @param parallel Split rows across the shared thread pool
+ * @throws std::logic_error if the image is mapped read-only
+ */
+void BMPFile::thresholdRows(const ThresholdKernel& kernel, int first_row, int end_row, bool parallel) {
+    const int w = width();
+
+    if (storage_ == Storage::Unpacked) {
+        forRowChunks(first_row, end_row, parallel, [&](int first, int end) {
+            for (int y = first; y < end; ++y) {
+                kernel.apply(&pixels_[index(0, y)], w);
+            }
+        });
+        return;
     }
+
+    if (isMapped() && !mapping_.isWritable())
+        throw std::logic_error("Image is mapped read-only");
+
+    uint8_t* base = nativeBase();
+    const size_t row_size = getRowSize();
+
+    // Both native layouts are thresholded in place
+    const bool bgra = is32bit();
+    forRowChunks(first_row, end_row, parallel, [&](int first, int end) {
+        for (int y = first; y < end; ++y) {
+            uint8_t* row = base + rowIndex(y) * row_size;
+            if (bgra) {
+                kernel.apply(reinterpret_cast<Pixel*>(row), w);
+            } else {
+                kernel.applyBGR24(row, w);
+            }
+        }
+    });
 }
 
 /**
@@ -183,11 +993,14 @@ void BMPFile::convertToBlackAndWhite() {
  * @param height Image height in pixels
  * @param format Pixel format (BGR24 or BGRA32)
  * @param fill_color Pixel to fill the image with (default: black)
+ * @param storage Pixel storage to allocate
  */
-void BMPFile::create(int width, int height, PixelFormat format, Pixel fill_color) {
+void BMPFile::create(int width, int height, PixelFormat format, Pixel fill_color, Storage storage) {
     if (width <= 0 || height <= 0)
         throw std::invalid_argument("Invalid image dimensions");
 
+    releasePixels();
+
     dib_header_ = DIBHeader{};
     dib_header_.width = width;
     dib_header_.height = -height; // top-down
@@ -198,6 +1011,26 @@ void BMPFile::create(int width, int height, PixelFormat format, Pixel fill_color
     bmp_header_.data_offset = sizeof(BMPHeader) + sizeof(DIBHeader);
     bmp_header_.file_size = bmp_header_.data_offset + dib_header_.image_size;
 
+    if (storage == Storage::Native) {
+        const size_t row_size = getRowSize();
+        packed_.assign(row_size * height, 0);
+
+        // Build one padded row, then replicate it
+        uint8_t* first = packed_.data();
+        for (int x = 0; x < width; ++x) {
+            uint8_t* p = first + x * bytesPerPixel();
+            p[0] = fill_color.b;
+            p[1] = fill_color.g;
+            p[2] = fill_color.r;
+            if (is32bit()) p[3] = fill_color.a;
+        }
+        for (int y = 1; y < height; ++y) {
+            std::memcpy(first + y * row_size, first, row_size);
+        }
+        storage_ = Storage::Native;
+        return;
+    }
+
     pixels_.resize(width * height, fill_color);
 }
 
@@ -206,8 +1039,7 @@ void BMPFile::create(int width, int height, PixelFormat format, Pixel fill_color
  * @return Row size in bytes
  */
 size_t BMPFile::getRowSize() const {
-    size_t bytesPerPixel = is32bit() ? 4 : 3;
-    return ((width() * bytesPerPixel + 3) & ~3);
+    return rowSize(width(), format());
 }
 
 /**
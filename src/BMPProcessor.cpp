@@ -1,12 +1,38 @@
 #include "BMPProcessor.hpp"
+#include "Stats.hpp"
+#include "ConsoleRenderer.hpp"
+#include "Raster/LineRasterizer.hpp"
 #include <iostream>
 #include <sstream>
 #include <getopt.h>
 #include <cstring>
 #include <iomanip>
+#include <algorithm>
+#include <tuple>
+
+namespace {
+
+/// Target size of one fused tile, small enough to stay in L2
+constexpr size_t kFusedTileBytes = 256 * 1024;
+
+/**
+ * @brief Builds the file name of a pyramid level next to an output file
+ * @param filename Output file path
+ * @param level Pyramid level
+ * @return "<stem>_mip<level>.bmp"
+ */
+std::string mipFilename(const std::string& filename, int level) {
+    std::string stem = filename;
+    const size_t dot = stem.rfind('.');
+    if (dot != std::string::npos && stem.find('/', dot) == std::string::npos) stem.erase(dot);
+    return stem + "_mip" + std::to_string(level) + ".bmp";
+}
+
+} // namespace
 
 BMPProcessor::Config BMPProcessor::Config::parse(int argc, char* argv[]) {
     Config config;
+    std::tie(config.preview_width, config.preview_height) = ConsoleRenderer::terminalSize();
 
     const struct option long_options[] = {
         {"input", required_argument, nullptr, 'i'},
@@ -15,12 +41,28 @@ BMPProcessor::Config BMPProcessor::Config::parse(int argc, char* argv[]) {
         {"color", required_argument, nullptr, 'c'},
         {"display", required_argument, nullptr, 'd'},
         {"strategy", required_argument, nullptr, 's'},
+        {"mmap", no_argument, nullptr, 'm'},
+        {"native", no_argument, nullptr, 'n'},
+        {"band-rows", required_argument, nullptr, 'b'},
+        {"fused", no_argument, nullptr, 'f'},
+        {"list", required_argument, nullptr, 'l'},
+        {"input-dir", required_argument, nullptr, 'I'},
+        {"output-pattern", required_argument, nullptr, 'p'},
+        {"workers", required_argument, nullptr, 'w'},
+        {"queue-depth", required_argument, nullptr, 'q'},
+        {"async-save", no_argument, nullptr, 'A'},
+        {"direct-io", no_argument, nullptr, 'D'},
+        {"stats", required_argument, nullptr, 'S'},
+        {"preview", required_argument, nullptr, 'P'},
+        {"mip", required_argument, nullptr, 'M'},
+        {"shapes", required_argument, nullptr, 'g'},
+        {"mono", no_argument, nullptr, '1'},
         {"help", no_argument, nullptr, 'h'},
         {nullptr, 0, nullptr, 0}
     };
 
     int opt;
-    while ((opt = getopt_long(argc, argv, "i:o:t:c:d:s:h", long_options, nullptr)) != -1) {
+    while ((opt = getopt_long(argc, argv, "i:o:t:c:d:s:mnb:fl:I:p:w:q:ADS:P:M:g:1h", long_options, nullptr)) != -1) {
         switch (opt) {
             case 'i':
                 config.input_file = optarg;
@@ -28,9 +70,14 @@ BMPProcessor::Config BMPProcessor::Config::parse(int argc, char* argv[]) {
             case 'o':
                 config.output_file = optarg;
                 break;
-            case 't':
-                config.thickness = std::max(1u, static_cast<unsigned int>(std::stoul(optarg)));
+            case 't': {
+                const unsigned long thickness = std::stoul(optarg);
+                if (thickness > static_cast<unsigned long>(LineRasterizer::kMaxCoordinate)) {
+                    throw std::runtime_error("Invalid thickness: " + std::string(optarg));
+                }
+                config.thickness = std::max(1u, static_cast<unsigned int>(thickness));
                 break;
+            }
             case 'c': {
                 std::istringstream iss(optarg);
                 std::string token;
@@ -62,6 +109,69 @@ BMPProcessor::Config BMPProcessor::Config::parse(int argc, char* argv[]) {
                     throw std::runtime_error("Unknown strategy: " + config.strategy_name);
                 }
                 break;
+            case 'm':
+                config.use_mmap = true;
+                break;
+            case 'n':
+                config.storage = BMPFile::Storage::Native;
+                break;
+            case 'b':
+                config.band_rows = static_cast<unsigned int>(std::stoul(optarg));
+                break;
+            case 'f':
+                config.fused = true;
+                break;
+            case 'l':
+                config.manifest_file = optarg;
+                break;
+            case 'I':
+                config.input_dir = optarg;
+                break;
+            case 'p':
+                config.output_pattern = optarg;
+                break;
+            case 'w':
+                config.workers = std::max(1u, static_cast<unsigned int>(std::stoul(optarg)));
+                break;
+            case 'q':
+                config.queue_depth = std::max(1u, static_cast<unsigned int>(std::stoul(optarg)));
+                break;
+            case 'A':
+                config.async_save = true;
+                break;
+            case 'D':
+                config.async_save = true;
+                config.direct_io = true;
+                break;
+            case 'S':
+                config.stats_file = optarg;
+                break;
+            case 'P': {
+                const std::string size = optarg;
+                const size_t sep = size.find('x');
+                config.preview_width = std::stoi(size.substr(0, sep));
+                config.preview_height = sep == std::string::npos ? 0 : std::stoi(size.substr(sep + 1));
+                if (config.preview_width < 0 || config.preview_height < 0) {
+                    throw std::runtime_error("Invalid preview size: " + size);
+                }
+                break;
+            }
+            case 'M': {
+                std::istringstream iss(optarg);
+                std::string token;
+                while (std::getline(iss, token, ',')) {
+                    const int level = std::stoi(token);
+                    if (level < 1) throw std::runtime_error("Invalid mip level: " + token);
+                    config.mip_levels.push_back(level);
+                }
+                break;
+            }
+            case 'g':
+                config.shapes_file = optarg;
+                break;
+            case '1':
+                config.mono = true;
+                break;
             case 'h':
                 printHelp(argv[0]);
                 std::exit(0);
@@ -70,8 +180,21 @@ BMPProcessor::Config BMPProcessor::Config::parse(int argc, char* argv[]) {
         }
     }
 
-    if (config.input_file.empty()) {
-        throw std::runtime_error("Input file is required. Use --input or -i.");
+    if (config.input_file.empty() && !config.isBatch()) {
+        throw std::runtime_error("Input file is required. Use --input, --list or --input-dir.");
+    }
+    if (!config.shapes_file.empty()) {
+        config.shapes = std::make_shared<const DisplayList>(
+            DisplayList::load(config.shapes_file, config.color, config.thickness));
+    }
+    if (config.isBatch() && (config.band_rows > 0 || config.fused)) {
+        throw std::runtime_error("Batch mode loads whole images and cannot be combined with --band-rows or --fused.");
+    }
+    if (!config.mip_levels.empty() && (config.band_rows > 0 || config.fused)) {
+        throw std::runtime_error("--mip needs the whole image and cannot be combined with --band-rows or --fused.");
+    }
+    if (config.mono && (config.band_rows > 0 || config.fused || config.async_save)) {
+        throw std::runtime_error("--mono cannot be combined with --band-rows, --fused, --async-save or --direct-io.");
     }
 
     return config;
@@ -82,7 +205,8 @@ void BMPProcessor::Config::printHelp(const std::string& program_name) {
     
     std::cout << "BMP Image Processor - Tool for processing BMP images with various drawing strategies\n\n"
               << "Usage:\n"
-              << indent << program_name << " -i <input.bmp> [OPTIONS]\n\n"
+              << indent << program_name << " -i <input.bmp> [OPTIONS]\n"
+              << indent << program_name << " (-l <list.txt> | -I <dir>) [OPTIONS]\n\n"
               << "Required arguments:\n"
               << indent << std::left << std::setw(20) << "-i, --input <file>" 
               << "Input BMP image file path\n\n"
@@ -92,16 +216,83 @@ void BMPProcessor::Config::printHelp(const std::string& program_name) {
               << indent << std::left << std::setw(20) << "-t, --thickness <n>" 
               << "Drawing thickness in pixels (default: 1)\n"
               << indent << std::left << std::setw(20) << "-c, --color R,G,B[,A]" 
-              << "Drawing color in RGBA format (default: 0,0,0,255)\n"
+              << "Drawing color in RGBA format, alpha below 255 blends (default: 0,0,0,255)\n"
               << indent << std::left << std::setw(20) << "-d, --display XY" 
               << "Characters for console display (foreground X, background Y) (default: \"# \")\n"
               << indent << std::left << std::setw(20) << "-s, --strategy <name>" 
               << "Drawing strategy: none, openmp, thread (default: none)\n"
+              << indent << std::left << std::setw(20) << "-m, --mmap" 
+              << "Map input file copy-on-write instead of reading it\n"
+              << indent << std::left << std::setw(20) << "-n, --native" 
+              << "Keep pixels in on-disk BGR24/BGRA32 layout\n"
+              << indent << std::left << std::setw(20) << "-b, --band-rows <n>" 
+              << "Stream the image in bands of n rows (no console preview, not in batch mode)\n"
+              << indent << std::left << std::setw(20) << "-f, --fused" 
+              << "Draw, threshold and save in a single cache-friendly pass (not in batch mode)\n"
+              << indent << std::left << std::setw(20) << "-l, --list <file>" 
+              << "Batch: process the input [output] pairs listed in a file\n"
+              << indent << std::left << std::setw(20) << "-I, --input-dir <dir>" 
+              << "Batch: process every .bmp file in a directory\n"
+              << indent << std::left << std::setw(20) << "-p, --output-pattern <p>" 
+              << "Batch output path, {name} and {index} are replaced (default: {name}_out.bmp)\n"
+              << indent << std::left << std::setw(20) << "-w, --workers <n>" 
+              << "Batch draw/threshold threads (default: 1)\n"
+              << indent << std::left << std::setw(20) << "-q, --queue-depth <n>" 
+              << "Batch images buffered between load, draw and save (default: 2)\n"
+              << indent << std::left << std::setw(20) << "-A, --async-save" 
+              << "Encode rows while a background thread writes the output\n"
+              << indent << std::left << std::setw(20) << "-D, --direct-io" 
+              << "Async save with O_DIRECT and preallocation, for large outputs\n"
+              << indent << std::left << std::setw(20) << "-S, --stats <file>" 
+              << "Write stage timings and counters as JSON (\"-\": stdout, without preview)\n"
+              << indent << std::left << std::setw(20) << "-P, --preview WxH" 
+              << "Fit console preview into W columns and H lines (default: terminal size, 0x0 = full size)\n"
+              << indent << std::left << std::setw(20) << "-M, --mip <k,...>" 
+              << "Also save pyramid levels k (1 = half size) as <output>_mip<k>.bmp\n"
+              << indent << std::left << std::setw(20) << "-g, --shapes <file>" 
+              << "Draw lines, rects, polylines and circles listed in a file instead of the cross\n"
+              << indent << std::left << std::setw(20) << "-1, --mono" 
+              << "Save the thresholded output as a 1-bit black and white BMP\n"
               << indent << std::left << std::setw(20) << "-h, --help" 
               << "Show this help message and exit\n\n"
               << "Examples:\n"
               << indent << program_name << " -i image.bmp -o result.bmp -t 3 -c 255,0,0 -s openmp\n"
-              << indent << program_name << " -i drawing.bmp --color 0,128,255,200 --display \"@.\"\n";
+              << indent << program_name << " -i drawing.bmp --color 0,128,255,200 --display \"@.\"\n"
+              << indent << program_name << " -I images/ -p out/{name}.bmp -s thread -w 2\n";
+}
+
+bool BMPProcessor::Config::save(const BMPFile& image, const std::string& filename) const {
+    // Levels the image is too small for are skipped, the rest are still saved
+    std::vector<BMPFile::MipOutput> mips;
+    for (int level : mip_levels) {
+        if (level > image.maxPyramidLevels()) {
+            // One write per line, batch savers may warn concurrently with the loader
+            std::cerr << ("Warning: " + filename + ": image too small for mip level " +
+                          std::to_string(level) + ", skipped\n") << std::flush;
+            continue;
+        }
+        mips.push_back({level, mipFilename(filename, level)});
+    }
+
+    if (mono) return image.saveMonochrome(filename, mips);
+    if (!async_save) return image.save(filename, mips);
+
+    AsyncFileWriter::Options options;
+    options.direct = direct_io;
+    options.preallocate = direct_io;
+    return image.saveAsync(filename, options, mips);
+}
+
+bool BMPProcessor::Config::save(const BinaryRaster& raster, const std::string& filename) const {
+    return raster.save(filename);
+}
+
+std::unique_ptr<IDrawStrategy> BMPProcessor::Config::createStrategy() const {
+    auto strategy = shapes ? DrawStrategyFactory::create(shapes, strategy_type)
+                           : DrawStrategyFactory::create(strategy_type);
+    strategy->setColor(color);
+    strategy->setThickness(thickness);
+    return strategy;
 }
 
 BMPProcessor::BMPProcessor(const Config& config, std::unique_ptr<IDrawStrategy> strategy)
@@ -115,13 +306,56 @@ BMPProcessor::BMPProcessor(const Config& config, std::unique_ptr<IDrawStrategy>
 
 bool BMPProcessor::process() {
     try {
-        bmp_.load(config_.input_file);
+        if (config_.band_rows > 0) {
+            processBands();
+            return true;
+        }
+
+        {
+            Stats::ScopedTimer timer(Stats::Stage::Load);
+            const bool loaded = config_.use_mmap
+                ? bmp_.mapFile(config_.input_file, BMPFile::MapMode::CopyOnWrite)
+                : bmp_.load(config_.input_file, config_.storage);
+            if (!loaded) {
+                throw std::runtime_error("Cannot read input file: " + config_.input_file);
+            }
+        }
+        if (config_.fused) {
+            processFused();
+            return true;
+        }
         //bmp_.convertToBlackAndWhite();        
-        if (draw_strategy_) {
+        // Opaque strokes threshold to one color, so they can go straight onto the bits
+        const bool draw_binary = config_.binaryOutput() && draw_strategy_ && draw_strategy_->canDrawBinary();
+        if (draw_strategy_ && !draw_binary) {
+            Stats::ScopedTimer timer(Stats::Stage::Draw);
             draw_strategy_->draw(bmp_);
         }
-        bmp_.convertToBlackAndWhite();
-        bmp_.save(config_.output_file);
+        if (config_.binaryOutput()) {
+            {
+                // Keep one bit per pixel from here on and release the pixels
+                Stats::ScopedTimer timer(Stats::Stage::Threshold);
+                bmp_.convertToBlackAndWhite(binary_);
+                bmp_ = BMPFile();
+            }
+            if (draw_binary) {
+                Stats::ScopedTimer timer(Stats::Stage::Draw);
+                draw_strategy_->drawBinary(binary_);
+            }
+            Stats::ScopedTimer timer(Stats::Stage::Save);
+            if (!config_.save(binary_, config_.output_file)) {
+                throw std::runtime_error("Failed to write output file: " + config_.output_file);
+            }
+            return true;
+        }
+        {
+            Stats::ScopedTimer timer(Stats::Stage::Threshold);
+            bmp_.convertToBlackAndWhite();
+        }
+        Stats::ScopedTimer timer(Stats::Stage::Save);
+        if (!config_.save(bmp_, config_.output_file)) {
+            throw std::runtime_error("Failed to write output file: " + config_.output_file);
+        }
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -129,21 +363,99 @@ bool BMPProcessor::process() {
     }
 }
 
-void BMPProcessor::display() const {
-    int width = bmp_.width();
-    int height = bmp_.height();
-    auto [on_char, off_char] = config_.display_chars;
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            try {
-                auto px = bmp_.getPixel(x, y);
-                uint8_t brightness = static_cast<uint8_t>(0.299 * px.r + 0.587 * px.g + 0.114 * px.b);
-                std::cout << (brightness > 127 ? on_char : off_char);
-            } catch (const std::out_of_range&) {
-                std::cout << '?';
+void BMPProcessor::processBands() {
+    BMPStreamReader reader;
+    if (!reader.open(config_.input_file)) {
+        throw std::runtime_error("Cannot read input file: " + config_.input_file);
+    }
+
+    BMPStreamWriter writer;
+    if (!writer.open(config_.output_file, reader.bmpHeader(), reader.dibHeader())) {
+        throw std::runtime_error("Cannot write output file: " + config_.output_file);
+    }
+
+    const int height = reader.height();
+    const int band_rows = static_cast<int>(std::min<unsigned int>(config_.band_rows, height));
+    BMPFile band;
+
+    for (int first_row = 0; first_row < height; first_row += band_rows) {
+        const int rows = std::min(band_rows, height - first_row);
+        {
+            Stats::ScopedTimer timer(Stats::Stage::Load);
+            if (!reader.readBand(band, first_row, rows)) {
+                throw std::runtime_error("Failed to read rows from " + config_.input_file);
             }
         }
-        std::cout << '\n';
+        if (draw_strategy_) {
+            Stats::ScopedTimer timer(Stats::Stage::Draw);
+            draw_strategy_->drawBand(band, {reader.width(), height, first_row, first_row, first_row + rows});
+        }
+        {
+            Stats::ScopedTimer timer(Stats::Stage::Threshold);
+            band.convertToBlackAndWhite();
+        }
+        Stats::ScopedTimer timer(Stats::Stage::Save);
+        if (!writer.writeBand(band, first_row)) {
+            throw std::runtime_error("Failed to write rows to " + config_.output_file);
+        }
     }
-}
\ No newline at end of file
+
+    if (!writer.close()) {
+        throw std::runtime_error("Failed to write output file: " + config_.output_file);
+    }
+}
+
+void BMPProcessor::processFused() {
+    if (bmp_.width() <= 0 || bmp_.height() <= 0) {
+        throw std::runtime_error("No image loaded from " + config_.input_file);
+    }
+
+    BMPStreamWriter writer;
+    if (!writer.open(config_.output_file, bmp_.bmpHeader(), bmp_.dibHeader())) {
+        throw std::runtime_error("Cannot write output file: " + config_.output_file);
+    }
+
+    const int width = bmp_.width();
+    const int height = bmp_.height();
+    const size_t row_bytes = static_cast<size_t>(width) * sizeof(BMPFile::Pixel);
+    const int tile_rows = static_cast<int>(std::clamp<size_t>(kFusedTileBytes / row_bytes, 1, height));
+    BMPFile tile;
+
+    for (int first_row = 0; first_row < height; first_row += tile_rows) {
+        const int rows = std::min(tile_rows, height - first_row);
+        if (tile.height() != rows) {
+            tile.create(width, rows, bmp_.format(), BMPFile::Pixel{}, BMPFile::Storage::Native);
+        }
+
+        if (draw_strategy_) {
+            Stats::ScopedTimer timer(Stats::Stage::Draw);
+            draw_strategy_->drawBand(bmp_, {width, height, 0, first_row, first_row + rows});
+        }
+        {
+            Stats::ScopedTimer timer(Stats::Stage::Threshold);
+            bmp_.convertRowsToBlackAndWhite(first_row, rows);
+        }
+
+        Stats::ScopedTimer timer(Stats::Stage::Save);
+        for (int y = 0; y < rows; ++y) {
+            bmp_.encodeRow(first_row + y, tile.rowData(y));
+        }
+        if (!writer.writeBand(tile, first_row)) {
+            throw std::runtime_error("Failed to write rows to " + config_.output_file);
+        }
+    }
+
+    if (!writer.close()) {
+        throw std::runtime_error("Failed to write output file: " + config_.output_file);
+    }
+}
+
+void BMPProcessor::display() const {
+    Stats::ScopedTimer timer(Stats::Stage::Display);
+    const ConsoleRenderer renderer(config_.display_chars, config_.preview_width, config_.preview_height);
+    if (binary_.width() > 0) {
+        renderer.render(binary_, std::cout);
+    } else {
+        renderer.render(bmp_, std::cout);
+    }
+}
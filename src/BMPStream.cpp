@@ -0,0 +1,146 @@
+/**
+ * @file BMPStream.cpp
+ * @brief Implementation of band-wise BMP reading and writing
+ */
+
+#include "BMPStream.hpp"
+#include "Stats.hpp"
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Gets position of a band inside the pixel block
+ * @param dib_header Image information header
+ * @param first_row First row of the band (0 = top)
+ * @param rows Number of rows in the band
+ * @return Index of the band's first row in file order
+ *
+ * Band rows are contiguous on disk; bottom-up files store them in reverse.
+ */
+int firstStoredRow(const BMPFile::DIBHeader& dib_header, int first_row, int rows) {
+    return dib_header.height > 0 ? dib_header.height - first_row - rows : first_row;
+}
+
+} // namespace
+
+/**
+ * @brief Opens a BMP file and reads its headers
+ * @param filename Path to BMP file
+ * @return true if headers describe a supported BMP, false on error
+ */
+bool BMPStreamReader::open(const std::string& filename) {
+    file_.close();
+    file_.open(filename, std::ios::binary);
+    if (!file_) return false;
+
+    file_.read(reinterpret_cast<char*>(&bmp_header_), sizeof(BMPFile::BMPHeader));
+    file_.read(reinterpret_cast<char*>(&dib_header_), sizeof(BMPFile::DIBHeader));
+    if (!file_) return false;
+
+    try {
+        BMPFile::validateHeaders(bmp_header_, dib_header_);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (width() <= 0 || height() <= 0) return false;
+
+    row_size_ = BMPFile::rowSize(width(), format());
+    Stats::add(Stats::Counter::BytesRead, sizeof(BMPFile::BMPHeader) + sizeof(BMPFile::DIBHeader));
+    return true;
+}
+
+/**
+ * @brief Reads consecutive rows into a band image
+ * @param band Destination image
+ * @param first_row First row to read
+ * @param rows Number of rows
+ * @return true on success, false on error
+ */
+bool BMPStreamReader::readBand(BMPFile& band, int first_row, int rows) {
+    if (!file_.is_open() || first_row < 0 || rows <= 0 || first_row + rows > height())
+        return false;
+
+    // Reuse the band's buffer while the shape stays the same
+    if (band.storage() != BMPFile::Storage::Native || band.width() != width() ||
+        band.height() != rows || band.format() != format()) {
+        band.create(width(), rows, format(), BMPFile::Pixel{}, BMPFile::Storage::Native);
+    }
+
+    const bool bottom_up = dib_header_.height > 0;
+    const int stored = firstStoredRow(dib_header_, first_row, rows);
+    file_.seekg(bmp_header_.data_offset + static_cast<std::streamoff>(stored) * row_size_);
+
+    for (int i = 0; i < rows; ++i) {
+        const int y = bottom_up ? rows - 1 - i : i;
+        file_.read(reinterpret_cast<char*>(band.rowData(y)), row_size_);
+    }
+    if (!file_) return false;
+
+    Stats::add(Stats::Counter::BytesRead, static_cast<uint64_t>(rows) * row_size_);
+    return true;
+}
+
+/**
+ * @brief Creates the output file and writes its headers
+ * @param filename Path to output file
+ * @param bmp_header File header
+ * @param dib_header Information header
+ * @return true on success, false on error
+ */
+bool BMPStreamWriter::open(const std::string& filename, const BMPFile::BMPHeader& bmp_header,
+                           const BMPFile::DIBHeader& dib_header) {
+    file_.close();
+    file_.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file_) return false;
+
+    dib_header_ = dib_header;
+    format_ = dib_header.bits_per_pixel == 32 ? BMPFile::PixelFormat::BGRA32
+                                              : BMPFile::PixelFormat::BGR24;
+    row_size_ = BMPFile::rowSize(dib_header.width, format_);
+
+    file_.write(reinterpret_cast<const char*>(&bmp_header), sizeof(BMPFile::BMPHeader));
+    file_.write(reinterpret_cast<const char*>(&dib_header), sizeof(BMPFile::DIBHeader));
+    if (!file_) return false;
+
+    Stats::add(Stats::Counter::BytesWritten, sizeof(BMPFile::BMPHeader) + sizeof(BMPFile::DIBHeader));
+    return true;
+}
+
+/**
+ * @brief Writes a band of rows at its place in the output
+ * @param band Natively stored band
+ * @param first_row Output row of the band's first row
+ * @return true on success, false on error
+ */
+bool BMPStreamWriter::writeBand(const BMPFile& band, int first_row) {
+    const int rows = band.height();
+    if (!file_.is_open() || band.storage() != BMPFile::Storage::Native ||
+        band.width() != dib_header_.width || band.format() != format_ || first_row < 0 ||
+        first_row + rows > std::abs(dib_header_.height))
+        return false;
+
+    // Pixels follow the headers directly, as in BMPFile::save
+    const std::streamoff pixel_offset = sizeof(BMPFile::BMPHeader) + sizeof(BMPFile::DIBHeader);
+    const bool bottom_up = dib_header_.height > 0;
+    const int stored = firstStoredRow(dib_header_, first_row, rows);
+    file_.seekp(pixel_offset + static_cast<std::streamoff>(stored) * row_size_);
+
+    for (int i = 0; i < rows; ++i) {
+        const int y = bottom_up ? rows - 1 - i : i;
+        file_.write(reinterpret_cast<const char*>(band.rowData(y)), row_size_);
+    }
+    if (!file_) return false;
+
+    Stats::add(Stats::Counter::BytesWritten, static_cast<uint64_t>(rows) * row_size_);
+    return true;
+}
+
+/**
+ * @brief Flushes and closes the output
+ * @return true if all data was written, false on error
+ */
+bool BMPStreamWriter::close() {
+    file_.close();
+    return !file_.fail();
+}
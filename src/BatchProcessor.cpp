@@ -0,0 +1,211 @@
+#include "BatchProcessor.hpp"
+#include "BoundedQueue.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+/**
+ * @struct BatchItem
+ * @brief Image travelling between pipeline stages
+ */
+struct BatchItem {
+    size_t job = 0;       ///< Index into the job list
+    BMPFile image;        ///< Loaded image, moved between stages with its buffers
+    BinaryRaster binary;  ///< Thresholded image when the config keeps bit-packed rasters
+};
+
+/**
+ * @brief Expand an output pattern for one input
+ * @param pattern Pattern with {name} and {index} placeholders
+ * @param input Input file path
+ * @param index Job number
+ * @return Output file path
+ */
+std::string expandPattern(const std::string& pattern, const std::string& input, size_t index) {
+    const std::pair<std::string, std::string> replacements[] = {
+        {"{name}", fs::path(input).stem().string()},
+        {"{index}", std::to_string(index)}
+    };
+
+    std::string result = pattern;
+    for (const auto& [key, value] : replacements) {
+        for (size_t pos = result.find(key); pos != std::string::npos; pos = result.find(key, pos + value.size())) {
+            result.replace(pos, key.size(), value);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Check if a path names a BMP file
+ * @param path File path
+ * @return true for a .bmp extension in any case
+ */
+bool isBmpFile(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".bmp";
+}
+
+} // namespace
+
+BatchProcessor::BatchProcessor(const BMPProcessor::Config& config)
+    : config_(config), jobs_(collectJobs(config)) {}
+
+std::vector<BatchProcessor::Job> BatchProcessor::collectJobs(const BMPProcessor::Config& config) {
+    std::vector<Job> jobs;
+
+    if (!config.manifest_file.empty()) {
+        std::ifstream manifest(config.manifest_file);
+        if (!manifest) {
+            throw std::runtime_error("Cannot read manifest: " + config.manifest_file);
+        }
+
+        std::string line;
+        while (std::getline(manifest, line)) {
+            std::istringstream iss(line);
+            Job job;
+            if (!(iss >> job.input) || job.input[0] == '#') continue;
+            if (!(iss >> job.output)) {
+                job.output = expandPattern(config.output_pattern, job.input, jobs.size());
+            }
+            jobs.push_back(std::move(job));
+        }
+    }
+
+    if (!config.input_dir.empty()) {
+        std::error_code ec;
+        std::vector<fs::path> inputs;
+        for (const auto& entry : fs::directory_iterator(config.input_dir, ec)) {
+            if (entry.is_regular_file() && isBmpFile(entry.path())) {
+                inputs.push_back(entry.path());
+            }
+        }
+        if (ec) {
+            throw std::runtime_error("Cannot read directory: " + config.input_dir);
+        }
+
+        // Directory order is unspecified, keep runs reproducible
+        std::sort(inputs.begin(), inputs.end());
+        for (const auto& input : inputs) {
+            jobs.push_back({input.string(), expandPattern(config.output_pattern, input.string(), jobs.size())});
+        }
+    }
+
+    return jobs;
+}
+
+bool BatchProcessor::run() {
+    failed_ = 0;
+
+    const size_t depth = std::max(1u, config_.queue_depth);
+    const unsigned workers = std::max(1u, config_.workers);
+    BoundedQueue<BatchItem> loaded(depth);
+    BoundedQueue<BatchItem> processed(depth);
+
+    // Stage 1: read images ahead of the workers
+    std::thread loader([&] {
+        for (size_t i = 0; i < jobs_.size(); ++i) {
+            BatchItem item{i, BMPFile(), BinaryRaster()};
+            try {
+                Stats::ScopedTimer timer(Stats::Stage::Load);
+                if (config_.use_mmap) {
+                    if (!item.image.mapFile(jobs_[i].input, BMPFile::MapMode::CopyOnWrite)) {
+                        throw std::runtime_error("cannot map file");
+                    }
+                } else if (!item.image.load(jobs_[i].input, config_.storage)) {
+                    throw std::runtime_error("cannot read file");
+                }
+            } catch (const std::exception& e) {
+                reportFailure(jobs_[i], e.what());
+                continue;
+            }
+            if (!loaded.push(std::move(item))) break;
+        }
+        loaded.close();
+    });
+
+    // Stage 2: draw and threshold, each worker with its own strategy
+    std::atomic<unsigned> running{workers};
+    std::vector<std::thread> compute;
+    compute.reserve(workers);
+    for (unsigned w = 0; w < workers; ++w) {
+        compute.emplace_back([&] {
+            auto strategy = config_.createStrategy();
+            const bool draw_binary = config_.binaryOutput() && strategy->canDrawBinary();
+
+            BatchItem item;
+            while (loaded.pop(item)) {
+                try {
+                    if (!draw_binary) {
+                        Stats::ScopedTimer timer(Stats::Stage::Draw);
+                        strategy->draw(item.image);
+                    }
+                    if (config_.binaryOutput()) {
+                        {
+                            Stats::ScopedTimer timer(Stats::Stage::Threshold);
+                            item.image.convertToBlackAndWhite(item.binary);
+                            item.image = BMPFile();
+                        }
+                        if (draw_binary) {
+                            Stats::ScopedTimer timer(Stats::Stage::Draw);
+                            strategy->drawBinary(item.binary);
+                        }
+                    } else {
+                        Stats::ScopedTimer timer(Stats::Stage::Threshold);
+                        item.image.convertToBlackAndWhite();
+                    }
+                } catch (const std::exception& e) {
+                    reportFailure(jobs_[item.job], e.what());
+                    continue;
+                }
+                if (!processed.push(std::move(item))) break;
+            }
+
+            if (--running == 0) processed.close();
+        });
+    }
+
+    // Stage 3: save on the calling thread while the others keep going
+    BatchItem item;
+    while (processed.pop(item)) {
+        Stats::ScopedTimer timer(Stats::Stage::Save);
+        try {
+            const bool saved = config_.binaryOutput() ? config_.save(item.binary, jobs_[item.job].output)
+                                                      : config_.save(item.image, jobs_[item.job].output);
+            if (!saved) {
+                reportFailure(jobs_[item.job], "cannot write " + jobs_[item.job].output);
+            }
+        } catch (const std::exception& e) {
+            reportFailure(jobs_[item.job], e.what());
+        }
+        // Hand the buffers back to the pool for the loader's next image
+        item.image = BMPFile();
+        item.binary = BinaryRaster();
+    }
+
+    loader.join();
+    for (auto& thread : compute) {
+        thread.join();
+    }
+
+    return failed_ == 0;
+}
+
+void BatchProcessor::reportFailure(const Job& job, const std::string& what) {
+    ++failed_;
+    std::lock_guard<std::mutex> lock(report_mutex_);
+    std::cerr << "Error: " << job.input << ": " << what << std::endl;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file BinaryRaster.cpp
+ * @brief Implementation of the bit-packed black and white image
+ */
+
+#include "BinaryRaster.hpp"
+#include "BMPFile.hpp"
+#include "Raster/LineRasterizer.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+/// Bytes of file data written per write call
+constexpr size_t kIoChunkBytes = 1 << 20;
+
+/**
+ * @brief Gets the in-memory mask of bits [first, last] of a word
+ * @param first First pixel within the word (0..63)
+ * @param last Last pixel within the word (first..63)
+ * @return Mask to apply to the word as loaded from a row
+ *
+ * Pixel 0 of a word is the top bit of its first byte, so on little-endian
+ * hosts the mask is built most-significant-first and then byte-swapped.
+ */
+uint64_t spanMask(int first, int last) {
+    const uint64_t bits = (~uint64_t(0) >> first) & (~uint64_t(0) << (63 - last));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return __builtin_bswap64(bits);
+#else
+    return bits;
+#endif
+}
+
+/**
+ * @brief Sets or clears masked bits of a word
+ * @param word Word to change
+ * @param mask Bits to change
+ * @param white Set the bits if true, clear them otherwise
+ */
+void applyMask(uint64_t& word, uint64_t mask, bool white) {
+    word = white ? word | mask : word & ~mask;
+}
+
+} // namespace
+
+/**
+ * @brief Creates a raster of one color
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param white Initial color of every pixel
+ * @param top_down Save rows top to bottom
+ * @throws std::invalid_argument if a dimension is negative
+ */
+void BinaryRaster::create(int width, int height, bool white, bool top_down) {
+    if (width < 0 || height < 0) throw std::invalid_argument("Invalid raster size");
+
+    width_ = width;
+    height_ = height;
+    top_down_ = top_down;
+    words_per_row_ = (static_cast<size_t>(width) + 63) / 64;
+    words_.assign(words_per_row_ * height, 0);
+
+    if (white && width > 0) {
+        for (int y = 0; y < height; ++y) fillSpan(y, 0, width - 1, true);
+    }
+}
+
+/**
+ * @brief Gets pixel by coordinates
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @return true for white
+ * @throws std::out_of_range if coordinates are out of bounds
+ */
+bool BinaryRaster::getPixel(int x, int y) const {
+    if (x < 0 || x >= width_ || y < 0 || y >= height_) throw std::out_of_range("Pixel coordinates out of range");
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(row(y));
+    return (bytes[x >> 3] >> (7 - (x & 7))) & 1;
+}
+
+/**
+ * @brief Sets pixel by coordinates
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param white New color
+ * @throws std::out_of_range if coordinates are out of bounds
+ */
+void BinaryRaster::setPixel(int x, int y, bool white) {
+    if (x < 0 || x >= width_ || y < 0 || y >= height_) throw std::out_of_range("Pixel coordinates out of range");
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(row(y));
+    const uint8_t bit = static_cast<uint8_t>(0x80 >> (x & 7));
+    bytes[x >> 3] = white ? bytes[x >> 3] | bit : bytes[x >> 3] & ~bit;
+}
+
+/**
+ * @brief Sets part of a row to one color
+ * @param y Y coordinate (pre-clipped)
+ * @param x0 First X coordinate (pre-clipped)
+ * @param x1 Last X coordinate, inclusive (pre-clipped)
+ * @param white Fill color
+ */
+void BinaryRaster::fillSpan(int y, int x0, int x1, bool white) {
+    uint64_t* words = row(y);
+    const int first = x0 >> 6;
+    const int last = x1 >> 6;
+    if (first == last) {
+        applyMask(words[first], spanMask(x0 & 63, x1 & 63), white);
+        return;
+    }
+
+    applyMask(words[first], spanMask(x0 & 63, 63), white);
+    std::fill(words + first + 1, words + last, white ? ~uint64_t(0) : 0);
+    applyMask(words[last], spanMask(0, x1 & 63), white);
+}
+
+/**
+ * @brief Sets a rectangle to one color
+ * @param x0 Left X coordinate (pre-clipped)
+ * @param y0 Top Y coordinate (pre-clipped)
+ * @param x1 Right X coordinate, inclusive (pre-clipped)
+ * @param y1 Bottom Y coordinate, inclusive (pre-clipped)
+ * @param white Fill color
+ */
+void BinaryRaster::fillRect(int x0, int y0, int x1, int y1, bool white) {
+    for (int y = y0; y <= y1; ++y) {
+        fillSpan(y, x0, x1, white);
+    }
+}
+
+/**
+ * @brief Draws a thick line clipped to the raster
+ * @param x0 Start X coordinate
+ * @param y0 Start Y coordinate
+ * @param x1 End X coordinate
+ * @param y1 End Y coordinate
+ * @param thickness Stroke width in pixels
+ * @param white Line color
+ * @return Pixels drawn
+ */
+uint64_t BinaryRaster::drawLine(int x0, int y0, int x1, int y1, unsigned int thickness, bool white) {
+    if (width_ == 0 || height_ == 0) return 0;
+
+    const int half = static_cast<int>(std::max(1u, thickness)) / 2;
+    const ClipRect clip{0, 0, width_ - 1, height_ - 1};
+    uint64_t drawn = 0;
+    LineRasterizer(x0, y0, x1, y1).forEachSpan(clip, half, [&](int y, int left, int right) {
+        fillSpan(y, left, right, white);
+        drawn += right - left + 1;
+    });
+    return drawn;
+}
+
+/**
+ * @brief Counts white pixels in part of a row
+ * @param y Y coordinate (pre-clipped)
+ * @param x_begin First X coordinate
+ * @param x_end X coordinate after the last one
+ * @return Number of set bits
+ */
+uint64_t BinaryRaster::countWhite(int y, int x_begin, int x_end) const {
+    if (x_begin >= x_end) return 0;
+
+    const uint64_t* words = row(y);
+    const int first = x_begin >> 6;
+    const int last = (x_end - 1) >> 6;
+    if (first == last) {
+        return __builtin_popcountll(words[first] & spanMask(x_begin & 63, (x_end - 1) & 63));
+    }
+
+    uint64_t count = __builtin_popcountll(words[first] & spanMask(x_begin & 63, 63));
+    for (int i = first + 1; i < last; ++i) count += __builtin_popcountll(words[i]);
+    return count + __builtin_popcountll(words[last] & spanMask(0, (x_end - 1) & 63));
+}
+
+/**
+ * @brief Saves the raster as a 1-bit palettized BMP
+ * @param filename Path to save file
+ * @return true if file saved successfully, false on error
+ */
+bool BinaryRaster::save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) return false;
+
+    BMPFile::BMPHeader bmp;
+    BMPFile::DIBHeader dib;
+    BMPFile::monochromeHeaders(width_, top_down_ ? -height_ : height_, bmp, dib);
+    file.write(reinterpret_cast<const char*>(&bmp), sizeof(bmp));
+    file.write(reinterpret_cast<const char*>(&dib), sizeof(dib));
+    file.write(reinterpret_cast<const char*>(BMPFile::kMonoPalette), sizeof(BMPFile::kMonoPalette));
+
+    // Rows are already in file layout; only the padding shrinks to 32 bits
+    const size_t row_size = BMPFile::monochromeRowSize(width_);
+    const int chunk_rows = static_cast<int>(std::clamp<size_t>(kIoChunkBytes / std::max<size_t>(row_size, 1), 1,
+                                                               std::max(height_, 1)));
+    PooledVector<uint8_t> chunk(chunk_rows * row_size);
+
+    for (int r0 = 0; r0 < height_; r0 += chunk_rows) {
+        const int rows = std::min(chunk_rows, height_ - r0);
+        for (int i = 0; i < rows; ++i) {
+            const int y = top_down_ ? r0 + i : height_ - 1 - (r0 + i);
+            std::memcpy(chunk.data() + i * row_size, row(y), row_size);
+        }
+        file.write(reinterpret_cast<const char*>(chunk.data()), rows * row_size);
+    }
+    if (!file.flush()) return false;
+
+    Stats::add(Stats::Counter::BytesWritten, bmp.file_size);
+    return true;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file BitPackKernel.cpp
+ * @brief Scalar and SIMD 1bpp row packing kernels
+ */
+
+#include "BitPackKernel.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if BMP_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using Pixel = BMPFile::Pixel;
+
+void packScalar(const Pixel* src, uint8_t* dst, int count) {
+    for (int x = 0; x < count; x += 8) {
+        const int n = std::min(8, count - x);
+        unsigned bits = 0;
+        for (int i = 0; i < n; ++i) bits |= (src[x + i].g >> 7) << (7 - i);
+        *dst++ = static_cast<uint8_t>(bits);
+    }
+}
+
+#if BMP_SIMD_X86
+
+// Green bytes are shuffled so that movemask, which reads lane bytes
+// lowest first, sees every group of eight pixels in reverse order: the
+// first pixel of a group lands on the most significant bit of its byte.
+
+BMP_TARGET("ssse3")
+void packSSSE3(const Pixel* src, uint8_t* dst, int count) {
+    // Pixels 0-3, 4-7, 8-11 and 12-15 go to bytes 7-4, 3-0, 15-12 and 11-8
+    const __m128i m0 = _mm_setr_epi8(-1, -1, -1, -1, 13, 9, 5, 1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i m1 = _mm_setr_epi8(13, 9, 5, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i m2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 13, 9, 5, 1);
+    const __m128i m3 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 13, 9, 5, 1, -1, -1, -1, -1);
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(src + x);
+        const __m128i g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(p), m0),
+                                                    _mm_shuffle_epi8(_mm_loadu_si128(p + 1), m1)),
+                                       _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(p + 2), m2),
+                                                    _mm_shuffle_epi8(_mm_loadu_si128(p + 3), m3)));
+        const unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(g));
+        dst[x / 8] = static_cast<uint8_t>(bits);
+        dst[x / 8 + 1] = static_cast<uint8_t>(bits >> 8);
+    }
+    packScalar(src + x, dst + x / 8, count - x);
+}
+
+BMP_TARGET("avx2")
+void packAVX2(const Pixel* src, uint8_t* dst, int count) {
+    // Register k puts the green bytes of each 128-bit lane, reversed, into
+    // dword k of that lane; the dword permute then pairs lane 1 (the later
+    // four pixels, low bits) with lane 0 in every qword
+    const __m256i m0 = _mm256_setr_epi8(13, 9, 5, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                        13, 9, 5, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i m1 = _mm256_setr_epi8(-1, -1, -1, -1, 13, 9, 5, 1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                        -1, -1, -1, -1, 13, 9, 5, 1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i m2 = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 13, 9, 5, 1, -1, -1, -1, -1,
+                                        -1, -1, -1, -1, -1, -1, -1, -1, 13, 9, 5, 1, -1, -1, -1, -1);
+    const __m256i m3 = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 13, 9, 5, 1,
+                                        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 13, 9, 5, 1);
+    const __m256i order = _mm256_setr_epi32(4, 0, 5, 1, 6, 2, 7, 3);
+
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        const __m256i* p = reinterpret_cast<const __m256i*>(src + x);
+        const __m256i g = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(_mm256_loadu_si256(p), m0),
+                                                          _mm256_shuffle_epi8(_mm256_loadu_si256(p + 1), m1)),
+                                          _mm256_or_si256(_mm256_shuffle_epi8(_mm256_loadu_si256(p + 2), m2),
+                                                          _mm256_shuffle_epi8(_mm256_loadu_si256(p + 3), m3)));
+        const uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_permutevar8x32_epi32(g, order)));
+        std::memcpy(dst + x / 8, &bits, sizeof(bits));
+    }
+    packSSSE3(src + x, dst + x / 8, count - x);
+}
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Gets kernel for a specific instruction set
+ * @param isa Requested instruction set
+ * @return Kernel, or nullptr if unsupported on this CPU
+ */
+const BitPackKernel* BitPackKernel::forIsa(Isa isa) {
+    static const BitPackKernel scalar(Isa::Scalar, "scalar", packScalar);
+#if BMP_SIMD_X86
+    static const BitPackKernel ssse3(Isa::SSSE3, "ssse3", packSSSE3);
+    static const BitPackKernel avx2(Isa::AVX2, "avx2", packAVX2);
+#endif
+
+    if (!CpuFeatures::get().supports(isa)) return nullptr;
+
+    switch (isa) {
+#if BMP_SIMD_X86
+        case Isa::SSSE3:
+            return &ssse3;
+        case Isa::AVX2:
+            return &avx2;
+#endif
+        default:
+            return &scalar;
+    }
+}
+
+/**
+ * @brief Gets the fastest kernel supported by the running CPU
+ * @return Kernel selected on first call
+ */
+const BitPackKernel& BitPackKernel::get() {
+    static const BitPackKernel& best = [] () -> const BitPackKernel& {
+        for (Isa isa : {Isa::AVX2, Isa::SSSE3}) {
+            if (const BitPackKernel* kernel = forIsa(isa)) return *kernel;
+        }
+        return *forIsa(Isa::Scalar);
+    }();
+    return best;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file BlendKernel.cpp
+ * @brief Scalar and SIMD source-over compositing kernels
+ */
+
+#include "BlendKernel.hpp"
+
+#if BMP_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using Pixel = BMPFile::Pixel;
+using Source = BlendKernel::Source;
+
+void blend32Scalar(Pixel* pixels, int count, const Source& source) {
+    for (int i = 0; i < count; ++i) {
+        Pixel& p = pixels[i];
+        p.b = source.blend(p.b, 0);
+        p.g = source.blend(p.g, 1);
+        p.r = source.blend(p.r, 2);
+        p.a = source.blend(p.a, 3);
+    }
+}
+
+void blend24Scalar(uint8_t* bytes, int count, const Source& source) {
+    for (int i = 0; i < count; ++i, bytes += 3) {
+        bytes[0] = source.blend(bytes[0], 0);
+        bytes[1] = source.blend(bytes[1], 1);
+        bytes[2] = source.blend(bytes[2], 2);
+    }
+}
+
+#if BMP_SIMD_X86
+
+// Channels are widened to 16-bit lanes, where d * inv + term never exceeds
+// 65153, and divided by 255 as (t + (t >> 8)) >> 8 before packing back.
+// BGR24 channels repeat every 3 bytes, so 16-byte blocks cycle through
+// three term patterns starting at B, G and R.
+
+BMP_TARGET("ssse3")
+inline __m128i blendLanes(__m128i lanes, __m128i inv, __m128i term) {
+    const __m128i t = _mm_add_epi16(_mm_mullo_epi16(lanes, inv), term);
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+BMP_TARGET("ssse3")
+inline __m128i blendBlock(__m128i v, __m128i inv, __m128i term_lo, __m128i term_hi) {
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_packus_epi16(blendLanes(_mm_unpacklo_epi8(v, zero), inv, term_lo),
+                            blendLanes(_mm_unpackhi_epi8(v, zero), inv, term_hi));
+}
+
+/**
+ * @brief Builds 16-bit terms for 8 consecutive BGR24 bytes
+ * @param source Prepared color
+ * @param phase Channel of the first byte
+ */
+BMP_TARGET("ssse3")
+inline __m128i terms24(const Source& source, int phase) {
+    alignas(16) uint16_t lanes[8];
+    for (int i = 0; i < 8; ++i) lanes[i] = source.term[(phase + i) % 3];
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(lanes));
+}
+
+BMP_TARGET("ssse3")
+void blend32SSSE3(Pixel* pixels, int count, const Source& source) {
+    const __m128i inv = _mm_set1_epi16(static_cast<short>(source.inv));
+    const __m128i term = _mm_set1_epi64x(static_cast<long long>(
+        source.term[0] | static_cast<uint64_t>(source.term[1]) << 16 |
+        static_cast<uint64_t>(source.term[2]) << 32 | static_cast<uint64_t>(source.term[3]) << 48));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(pixels + i);
+        _mm_storeu_si128(p, blendBlock(_mm_loadu_si128(p), inv, term, term));
+    }
+    blend32Scalar(pixels + i, count - i, source);
+}
+
+BMP_TARGET("ssse3")
+void blend24SSSE3(uint8_t* bytes, int count, const Source& source) {
+    const __m128i inv = _mm_set1_epi16(static_cast<short>(source.inv));
+    // Byte offsets 0, 8, 16 of a 48-byte block start at B, R and G
+    const __m128i term_b = terms24(source, 0);
+    const __m128i term_g = terms24(source, 1);
+    const __m128i term_r = terms24(source, 2);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i* p = reinterpret_cast<__m128i*>(bytes + i * 3);
+        _mm_storeu_si128(p, blendBlock(_mm_loadu_si128(p), inv, term_b, term_r));
+        _mm_storeu_si128(p + 1, blendBlock(_mm_loadu_si128(p + 1), inv, term_g, term_b));
+        _mm_storeu_si128(p + 2, blendBlock(_mm_loadu_si128(p + 2), inv, term_r, term_g));
+    }
+    blend24Scalar(bytes + i * 3, count - i, source);
+}
+
+BMP_TARGET("avx2")
+inline __m128i blendBlockAVX2(__m128i v, __m256i inv, __m256i term) {
+    const __m256i lanes = _mm256_cvtepu8_epi16(v);
+    const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(lanes, inv), term);
+    const __m256i q = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+    return _mm_packus_epi16(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+}
+
+BMP_TARGET("avx2")
+void blend32AVX2(Pixel* pixels, int count, const Source& source) {
+    const __m256i inv = _mm256_set1_epi16(static_cast<short>(source.inv));
+    const __m256i term = _mm256_set1_epi64x(static_cast<long long>(
+        source.term[0] | static_cast<uint64_t>(source.term[1]) << 16 |
+        static_cast<uint64_t>(source.term[2]) << 32 | static_cast<uint64_t>(source.term[3]) << 48));
+    const __m256i zero = _mm256_setzero_si256();
+
+    // Unpack and pack both stay within 128-bit lanes, which keeps pixel order
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(pixels + i);
+        const __m256i v = _mm256_loadu_si256(p);
+        const __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(v, zero), inv), term);
+        const __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(v, zero), inv), term);
+        _mm256_storeu_si256(p, _mm256_packus_epi16(
+            _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8),
+            _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8)));
+    }
+    blend32SSSE3(pixels + i, count - i, source);
+}
+
+BMP_TARGET("avx2")
+void blend24AVX2(uint8_t* bytes, int count, const Source& source) {
+    const __m256i inv = _mm256_set1_epi16(static_cast<short>(source.inv));
+    // 16-byte blocks k = 0, 1, 2 of a 48-byte block start at channel k
+    const __m256i term_b = _mm256_set_m128i(terms24(source, 2), terms24(source, 0));
+    const __m256i term_g = _mm256_set_m128i(terms24(source, 0), terms24(source, 1));
+    const __m256i term_r = _mm256_set_m128i(terms24(source, 1), terms24(source, 2));
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i* p = reinterpret_cast<__m128i*>(bytes + i * 3);
+        _mm_storeu_si128(p, blendBlockAVX2(_mm_loadu_si128(p), inv, term_b));
+        _mm_storeu_si128(p + 1, blendBlockAVX2(_mm_loadu_si128(p + 1), inv, term_g));
+        _mm_storeu_si128(p + 2, blendBlockAVX2(_mm_loadu_si128(p + 2), inv, term_r));
+    }
+    blend24Scalar(bytes + i * 3, count - i, source);
+}
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Gets kernel for a specific instruction set
+ * @param isa Requested instruction set
+ * @return Kernel, or nullptr if unsupported on this CPU
+ */
+const BlendKernel* BlendKernel::forIsa(Isa isa) {
+    static const BlendKernel scalar(Isa::Scalar, "scalar", blend32Scalar, blend24Scalar);
+#if BMP_SIMD_X86
+    static const BlendKernel ssse3(Isa::SSSE3, "ssse3", blend32SSSE3, blend24SSSE3);
+    static const BlendKernel avx2(Isa::AVX2, "avx2", blend32AVX2, blend24AVX2);
+#endif
+
+    if (!CpuFeatures::get().supports(isa)) return nullptr;
+
+    switch (isa) {
+#if BMP_SIMD_X86
+        case Isa::SSSE3:
+            return &ssse3;
+        case Isa::AVX2:
+            return &avx2;
+#endif
+        default:
+            return &scalar;
+    }
+}
+
+/**
+ * @brief Gets the fastest kernel supported by the running CPU
+ * @return Kernel selected on first call
+ */
+const BlendKernel& BlendKernel::get() {
+    static const BlendKernel& best = [] () -> const BlendKernel& {
+        for (Isa isa : {Isa::AVX2, Isa::SSSE3}) {
+            if (const BlendKernel* kernel = forIsa(isa)) return *kernel;
+        }
+        return *forIsa(Isa::Scalar);
+    }();
+    return best;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file BoxFilterKernel.cpp
+ * @brief Scalar and SIMD 2x2 box filter kernels
+ */
+
+#include "BoxFilterKernel.hpp"
+
+#if BMP_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using Pixel = BMPFile::Pixel;
+
+void boxScalar(const Pixel* row0, const Pixel* row1, Pixel* dst, int count) {
+    for (int x = 0; x < count; ++x) {
+        const Pixel& a = row0[2 * x];
+        const Pixel& b = row0[2 * x + 1];
+        const Pixel& c = row1[2 * x];
+        const Pixel& d = row1[2 * x + 1];
+        dst[x].b = static_cast<uint8_t>((a.b + b.b + c.b + d.b + 2) >> 2);
+        dst[x].g = static_cast<uint8_t>((a.g + b.g + c.g + d.g + 2) >> 2);
+        dst[x].r = static_cast<uint8_t>((a.r + b.r + c.r + d.r + 2) >> 2);
+        dst[x].a = static_cast<uint8_t>((a.a + b.a + c.a + d.a + 2) >> 2);
+    }
+}
+
+#if BMP_SIMD_X86
+
+// Channels are widened to 16 bits and the two rows added; the 64-bit
+// halves then hold horizontally adjacent pixels, so adding the low and
+// high halves of a pair of registers sums each 2x2 block.
+
+BMP_TARGET("ssse3")
+void boxSSSE3(const Pixel* row0, const Pixel* row1, Pixel* dst, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(2);
+
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        const __m128i* a = reinterpret_cast<const __m128i*>(row0 + 2 * x);
+        const __m128i* b = reinterpret_cast<const __m128i*>(row1 + 2 * x);
+        const __m128i a0 = _mm_loadu_si128(a);
+        const __m128i a1 = _mm_loadu_si128(a + 1);
+        const __m128i b0 = _mm_loadu_si128(b);
+        const __m128i b1 = _mm_loadu_si128(b + 1);
+
+        const __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+        const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+        const __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+        const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+        const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+        const __m128i hi = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+                         _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(lo, round), 2),
+                                          _mm_srli_epi16(_mm_add_epi16(hi, round), 2)));
+    }
+    boxScalar(row0 + 2 * x, row1 + 2 * x, dst + x, count - x);
+}
+
+BMP_TARGET("avx2")
+void boxAVX2(const Pixel* row0, const Pixel* row1, Pixel* dst, int count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i round = _mm256_set1_epi16(2);
+
+    // Unpack and pack stay within 128-bit lanes; a final qword permute
+    // restores pixel order
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        const __m256i* a = reinterpret_cast<const __m256i*>(row0 + 2 * x);
+        const __m256i* b = reinterpret_cast<const __m256i*>(row1 + 2 * x);
+        const __m256i a0 = _mm256_loadu_si256(a);
+        const __m256i a1 = _mm256_loadu_si256(a + 1);
+        const __m256i b0 = _mm256_loadu_si256(b);
+        const __m256i b1 = _mm256_loadu_si256(b + 1);
+
+        const __m256i s0 = _mm256_add_epi16(_mm256_unpacklo_epi8(a0, zero), _mm256_unpacklo_epi8(b0, zero));
+        const __m256i s1 = _mm256_add_epi16(_mm256_unpackhi_epi8(a0, zero), _mm256_unpackhi_epi8(b0, zero));
+        const __m256i s2 = _mm256_add_epi16(_mm256_unpacklo_epi8(a1, zero), _mm256_unpacklo_epi8(b1, zero));
+        const __m256i s3 = _mm256_add_epi16(_mm256_unpackhi_epi8(a1, zero), _mm256_unpackhi_epi8(b1, zero));
+
+        const __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi64(s0, s1), _mm256_unpackhi_epi64(s0, s1));
+        const __m256i hi = _mm256_add_epi16(_mm256_unpacklo_epi64(s2, s3), _mm256_unpackhi_epi64(s2, s3));
+
+        const __m256i packed = _mm256_packus_epi16(_mm256_srli_epi16(_mm256_add_epi16(lo, round), 2),
+                                                   _mm256_srli_epi16(_mm256_add_epi16(hi, round), 2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x),
+                            _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    boxSSSE3(row0 + 2 * x, row1 + 2 * x, dst + x, count - x);
+}
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Gets kernel for a specific instruction set
+ * @param isa Requested instruction set
+ * @return Kernel, or nullptr if unsupported on this CPU
+ */
+const BoxFilterKernel* BoxFilterKernel::forIsa(Isa isa) {
+    static const BoxFilterKernel scalar(Isa::Scalar, "scalar", boxScalar);
+#if BMP_SIMD_X86
+    static const BoxFilterKernel ssse3(Isa::SSSE3, "ssse3", boxSSSE3);
+    static const BoxFilterKernel avx2(Isa::AVX2, "avx2", boxAVX2);
+#endif
+
+    if (!CpuFeatures::get().supports(isa)) return nullptr;
+
+    switch (isa) {
+#if BMP_SIMD_X86
+        case Isa::SSSE3:
+            return &ssse3;
+        case Isa::AVX2:
+            return &avx2;
+#endif
+        default:
+            return &scalar;
+    }
+}
+
+/**
+ * @brief Gets the fastest kernel supported by the running CPU
+ * @return Kernel selected on first call
+ */
+const BoxFilterKernel& BoxFilterKernel::get() {
+    static const BoxFilterKernel& best = [] () -> const BoxFilterKernel& {
+        for (Isa isa : {Isa::AVX2, Isa::SSSE3}) {
+            if (const BoxFilterKernel* kernel = forIsa(isa)) return *kernel;
+        }
+        return *forIsa(Isa::Scalar);
+    }();
+    return best;
+}
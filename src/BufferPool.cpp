@@ -0,0 +1,191 @@
+/**
+ * @file BufferPool.cpp
+ * @brief Implementation of the size-classed buffer cache
+ */
+
+#include "BufferPool.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <new>
+#include <sys/mman.h>
+
+namespace {
+
+/// Smallest size class; also the class granularity of small blocks
+constexpr size_t kMinClassBytes = BufferPool::kAlignment;
+
+/**
+ * @brief Gets the largest power of two not above a value
+ * @param value Value, at least one
+ * @return Power of two
+ */
+size_t floorPow2(size_t value) {
+    size_t p = 1;
+    while (p <= value / 2) p *= 2;
+    return p;
+}
+
+} // namespace
+
+BufferPool::~BufferPool() {
+    trim();
+}
+
+/**
+ * @brief Gets pool shared by the whole process
+ * @return Pool used by PoolAllocator
+ */
+BufferPool& BufferPool::shared() {
+    // Never destroyed: images in static storage may release blocks at exit
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+/**
+ * @brief Rounds a request up to its size class
+ * @param bytes Requested size
+ * @return Size of the block that serves it
+ */
+size_t BufferPool::classSize(size_t bytes) {
+    if (bytes <= kMinClassBytes) return kMinClassBytes;
+
+    // Four classes per power of two; huge-page blocks use whole pages
+    size_t step = std::max(kMinClassBytes, floorPow2(bytes - 1) / 4);
+    if (bytes > kHugePageBytes) step = std::max(step, kHugePageBytes);
+    return (bytes + step - 1) / step * step;
+}
+
+/**
+ * @brief Gets a block
+ * @param bytes Requested size
+ * @return Block of at least bytes, or nullptr for zero bytes
+ * @throws std::bad_alloc if the system is out of memory
+ */
+void* BufferPool::acquire(size_t bytes) {
+    if (bytes == 0) return nullptr;
+    const size_t size = classSize(bytes);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = free_.find(size);
+        if (it != free_.end() && !it->second.empty()) {
+            void* block = it->second.back();
+            it->second.pop_back();
+            cached_bytes_ -= size;
+            reuses_.fetch_add(1, std::memory_order_relaxed);
+            Stats::add(Stats::Counter::BufferReuses, 1);
+            return block;
+        }
+    }
+
+    void* block = allocateBlock(size);
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    Stats::add(Stats::Counter::BufferAllocations, 1);
+    return block;
+}
+
+/**
+ * @brief Returns a block for reuse
+ * @param block Block from acquire(), may be nullptr
+ * @param bytes Size passed to acquire()
+ */
+void BufferPool::release(void* block, size_t bytes) {
+    if (!block) return;
+    const size_t size = classSize(bytes);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cached_bytes_ + size <= cache_limit_) {
+            try {
+                free_[size].push_back(block);
+                cached_bytes_ += size;
+                return;
+            } catch (const std::bad_alloc&) {
+                // No room to remember it: free it below
+            }
+        }
+    }
+
+    freeBlock(block, size);
+}
+
+/**
+ * @brief Frees every cached block
+ */
+void BufferPool::trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [size, blocks] : free_) {
+        for (void* block : blocks) freeBlock(block, size);
+    }
+    free_.clear();
+    cached_bytes_ = 0;
+}
+
+/**
+ * @brief Sets how many bytes the free lists may hold
+ * @param bytes New limit
+ */
+void BufferPool::setCacheLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_limit_ = bytes;
+    shrinkToLimit();
+}
+
+/**
+ * @brief Frees cached blocks, largest first, until the limit holds
+ */
+void BufferPool::shrinkToLimit() {
+    for (auto it = free_.rbegin(); it != free_.rend() && cached_bytes_ > cache_limit_; ++it) {
+        auto& blocks = it->second;
+        while (!blocks.empty() && cached_bytes_ > cache_limit_) {
+            freeBlock(blocks.back(), it->first);
+            blocks.pop_back();
+            cached_bytes_ -= it->first;
+        }
+    }
+}
+
+/**
+ * @brief Gets a fresh block from the system
+ * @param size Class size
+ * @return Block
+ * @throws std::bad_alloc on failure
+ */
+void* BufferPool::allocateBlock(size_t size) {
+    if (size < kHugePageBytes) {
+        return ::operator new(size, std::align_val_t(kAlignment));
+    }
+
+    // Map one huge page extra and trim it so the block starts on a huge
+    // page boundary; class sizes from here up are whole huge pages
+    const size_t mapped = size + kHugePageBytes;
+    void* region = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) throw std::bad_alloc();
+
+    const uintptr_t start = reinterpret_cast<uintptr_t>(region);
+    const uintptr_t aligned = (start + kHugePageBytes - 1) & ~(uintptr_t(kHugePageBytes) - 1);
+    if (aligned > start) ::munmap(region, aligned - start);
+    if (aligned + size < start + mapped) {
+        ::munmap(reinterpret_cast<void*>(aligned + size), start + mapped - aligned - size);
+    }
+
+    void* block = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+    // Only a hint: without transparent huge pages the block uses normal pages
+    ::madvise(block, size, MADV_HUGEPAGE);
+#endif
+    return block;
+}
+
+/**
+ * @brief Gives a block back to the system
+ * @param block Block from allocateBlock()
+ * @param size Class size
+ */
+void BufferPool::freeBlock(void* block, size_t size) {
+    if (size < kHugePageBytes) {
+        ::operator delete(block, std::align_val_t(kAlignment));
+    } else {
+        ::munmap(block, size);
+    }
+}
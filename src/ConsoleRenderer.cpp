@@ -0,0 +1,149 @@
+/**
+ * @file ConsoleRenderer.cpp
+ * @brief Implementation of buffered console rendering
+ */
+
+#include "ConsoleRenderer.hpp"
+#include "RowCodec.hpp"
+#include "ThresholdKernel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+std::pair<int, int> ConsoleRenderer::terminalSize() {
+    winsize size{};
+    if (::ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 1) {
+        return {size.ws_col, size.ws_row - 1};
+    }
+    return {120, 60};
+}
+
+std::pair<int, int> ConsoleRenderer::frameSize(int width, int height) const {
+    double scale = 1.0;
+    if (max_width_ > 0) scale = std::max(scale, static_cast<double>(width) / max_width_);
+    if (max_height_ > 0) scale = std::max(scale, static_cast<double>(height) / max_height_);
+
+    const int cols = std::clamp(static_cast<int>(std::lround(width / scale)), 1, width);
+    const int lines = std::clamp(static_cast<int>(std::lround(height / scale)), 1, height);
+    return {cols, lines};
+}
+
+std::vector<int> ConsoleRenderer::columnBounds(int width, int cols) {
+    // Column c covers source pixels [x_begin[c], x_begin[c + 1])
+    std::vector<int> x_begin(cols + 1);
+    for (int c = 0; c <= cols; ++c) {
+        x_begin[c] = static_cast<int>(static_cast<int64_t>(c) * width / cols);
+    }
+    return x_begin;
+}
+
+void ConsoleRenderer::write(const std::string& frame, std::ostream& os) {
+    os.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+    os.flush();
+}
+
+std::string ConsoleRenderer::render(const BMPFile& image) const {
+    const int width = image.width();
+    const int height = image.height();
+    if (width <= 0 || height <= 0) return {};
+
+    const auto [cols, lines] = frameSize(width, height);
+    const auto [on_char, off_char] = chars_;
+
+    const std::vector<int> x_begin = columnBounds(width, cols);
+
+    std::string frame;
+    frame.reserve(static_cast<size_t>(cols + 1) * lines);
+    std::vector<uint64_t> sums(cols);
+    std::vector<BMPFile::Pixel> scratch;
+    const bool native = image.storage() == BMPFile::Storage::Native;
+    if (native) scratch.resize(width);
+    const RowCodec::DecodeFn decode = RowCodec::get().decoder(image.format());
+
+    for (int line = 0; line < lines; ++line) {
+        const int y_begin = static_cast<int>(static_cast<int64_t>(line) * height / lines);
+        const int y_end = static_cast<int>(static_cast<int64_t>(line + 1) * height / lines);
+        std::fill(sums.begin(), sums.end(), 0);
+
+        const BMPFile::Pixel* row = nullptr;
+        for (int y = y_begin; y < y_end; ++y) {
+            if (native) {
+                decode(image.rowData(y), scratch.data(), width);
+                row = scratch.data();
+            } else {
+                row = image.row(y);
+            }
+
+            for (int c = 0; c < cols; ++c) {
+                uint64_t sum = 0;
+                for (int x = x_begin[c]; x < x_begin[c + 1]; ++x) {
+                    sum += ThresholdKernel::kWeightR * row[x].r + ThresholdKernel::kWeightG * row[x].g +
+                           ThresholdKernel::kWeightB * row[x].b;
+                }
+                sums[c] += sum;
+            }
+        }
+
+        for (int c = 0; c < cols; ++c) {
+            const uint64_t count = static_cast<uint64_t>(x_begin[c + 1] - x_begin[c]) * (y_end - y_begin);
+
+            // Single pixels use the exact reference threshold, boxes their average luma
+            bool bright;
+            if (count == 1) {
+                const BMPFile::Pixel& p = row[x_begin[c]];
+                bright = ThresholdKernel::isWhite(p.r, p.g, p.b);
+            } else {
+                bright = sums[c] > ThresholdKernel::kTie * count;
+            }
+            frame += bright ? on_char : off_char;
+        }
+        frame += '\n';
+    }
+
+    return frame;
+}
+
+void ConsoleRenderer::render(const BMPFile& image, std::ostream& os) const {
+    write(render(image), os);
+}
+
+std::string ConsoleRenderer::render(const BinaryRaster& raster) const {
+    const int width = raster.width();
+    const int height = raster.height();
+    if (width <= 0 || height <= 0) return {};
+
+    const auto [cols, lines] = frameSize(width, height);
+    const auto [on_char, off_char] = chars_;
+    const std::vector<int> x_begin = columnBounds(width, cols);
+
+    std::string frame;
+    frame.reserve(static_cast<size_t>(cols + 1) * lines);
+    std::vector<uint64_t> whites(cols);
+
+    for (int line = 0; line < lines; ++line) {
+        const int y_begin = static_cast<int>(static_cast<int64_t>(line) * height / lines);
+        const int y_end = static_cast<int>(static_cast<int64_t>(line + 1) * height / lines);
+        std::fill(whites.begin(), whites.end(), 0);
+
+        for (int y = y_begin; y < y_end; ++y) {
+            for (int c = 0; c < cols; ++c) {
+                whites[c] += raster.countWhite(y, x_begin[c], x_begin[c + 1]);
+            }
+        }
+
+        // Same test as the average luma of 0/255 pixels against the threshold
+        for (int c = 0; c < cols; ++c) {
+            const uint64_t count = static_cast<uint64_t>(x_begin[c + 1] - x_begin[c]) * (y_end - y_begin);
+            frame += whites[c] * 255 > 128 * count ? on_char : off_char;
+        }
+        frame += '\n';
+    }
+
+    return frame;
+}
+
+void ConsoleRenderer::render(const BinaryRaster& raster, std::ostream& os) const {
+    write(render(raster), os);
+}
@@ -0,0 +1,25 @@
+/**
+ * @file CpuFeatures.cpp
+ * @brief Implementation of runtime CPU feature detection
+ */
+
+#include "CpuFeatures.hpp"
+
+/**
+ * @brief Gets features of the running CPU
+ * @return Features detected on first call
+ */
+const CpuFeatures& CpuFeatures::get() {
+    static const CpuFeatures features = [] {
+        CpuFeatures f;
+#if BMP_SIMD_X86
+        __builtin_cpu_init();
+        f.sse2 = __builtin_cpu_supports("sse2");
+        f.ssse3 = __builtin_cpu_supports("ssse3");
+        f.sse41 = __builtin_cpu_supports("sse4.1");
+        f.avx2 = __builtin_cpu_supports("avx2");
+#endif
+        return f;
+    }();
+    return features;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file MappedFile.cpp
+ * @brief Implementation of memory-mapped file access
+ */
+
+#include "MappedFile.hpp"
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      mode_(other.mode_) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        mode_ = other.mode_;
+    }
+    return *this;
+}
+
+/**
+ * @brief Maps a file into memory
+ * @param filename Path to the file
+ * @param mode Access mode of the mapping
+ * @return true if mapping succeeded, false on error
+ */
+bool MappedFile::open(const std::string& filename, Mode mode) {
+    close();
+
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // A private mapping never writes back, so a read-only descriptor is enough
+    const int prot = (mode == Mode::CopyOnWrite) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), prot, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) return false;
+
+    data_ = static_cast<uint8_t*>(addr);
+    size_ = static_cast<size_t>(st.st_size);
+    mode_ = mode;
+    return true;
+}
+
+/**
+ * @brief Unmaps the file
+ */
+void MappedFile::close() {
+    if (data_) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
@@ -0,0 +1,238 @@
+/**
+ * @file DisplayList.cpp
+ * @brief Recording and loading of display list primitives
+ */
+
+#include "Raster/DisplayList.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Parses an "R,G,B[,A]" color
+ * @param text Color text
+ * @param color Receives the color
+ * @return false if a component is missing or out of range
+ */
+bool parseColor(const std::string& text, BMPFile::Pixel& color) {
+    std::istringstream iss(text);
+    std::string token;
+    int rgba[4] = {0, 0, 0, 255};
+    int count = 0;
+    while (std::getline(iss, token, ',')) {
+        if (count == 4) return false;
+        try {
+            rgba[count] = std::stoi(token);
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (rgba[count] < 0 || rgba[count] > 255) return false;
+        ++count;
+    }
+    if (count < 3) return false;
+
+    color = {static_cast<uint8_t>(rgba[0]), static_cast<uint8_t>(rgba[1]),
+             static_cast<uint8_t>(rgba[2]), static_cast<uint8_t>(rgba[3])};
+    return true;
+}
+
+} // namespace
+
+void DisplayList::addLine(int x0, int y0, int x1, int y1, BMPFile::Pixel color, unsigned int thickness) {
+    primitives_.push_back({Primitive::Kind::Line, x0, y0, x1, y1,
+                           static_cast<int>(std::max(1u, thickness) / 2), color, {}});
+}
+
+void DisplayList::addRect(int x0, int y0, int x1, int y1, BMPFile::Pixel color, unsigned int thickness,
+                          bool filled) {
+    primitives_.push_back({filled ? Primitive::Kind::FilledRect : Primitive::Kind::Rect, x0, y0, x1, y1,
+                           filled ? 0 : static_cast<int>(std::max(1u, thickness) / 2), color, {}});
+}
+
+void DisplayList::addPolyline(const std::vector<std::pair<int, int>>& points, BMPFile::Pixel color,
+                              unsigned int thickness, bool closed) {
+    if (points.empty()) return;
+
+    Primitive primitive{Primitive::Kind::Polyline, points[0].first, points[0].second, points[0].first,
+                        points[0].second, static_cast<int>(std::max(1u, thickness) / 2), color, points};
+    for (const auto& [x, y] : points) {
+        primitive.x0 = std::min(primitive.x0, x);
+        primitive.y0 = std::min(primitive.y0, y);
+        primitive.x1 = std::max(primitive.x1, x);
+        primitive.y1 = std::max(primitive.y1, y);
+    }
+    if (closed && points.size() > 2) primitive.points.push_back(points[0]);
+    primitives_.push_back(std::move(primitive));
+}
+
+void DisplayList::addCircle(int cx, int cy, int radius, BMPFile::Pixel color, unsigned int thickness,
+                            bool filled) {
+    if (radius < 0) throw std::invalid_argument("Negative circle radius");
+    primitives_.push_back({filled ? Primitive::Kind::FilledCircle : Primitive::Kind::Circle, cx, cy, radius, 0,
+                           filled ? 0 : static_cast<int>(std::max(1u, thickness) / 2), color, {}});
+}
+
+/**
+ * @brief Gets the rectangle a primitive can touch
+ * @param primitive Primitive
+ * @return Inclusive bounds, saturated to the int range
+ */
+ClipRect DisplayList::bounds(const Primitive& primitive) {
+    int64_t left, top, right, bottom;
+    if (primitive.kind == Primitive::Kind::Circle || primitive.kind == Primitive::Kind::FilledCircle) {
+        const int64_t reach = static_cast<int64_t>(primitive.x1) + primitive.half;
+        left = primitive.x0 - reach;
+        right = primitive.x0 + reach;
+        top = primitive.y0 - reach;
+        bottom = primitive.y0 + reach;
+    } else {
+        left = std::min(primitive.x0, primitive.x1) - static_cast<int64_t>(primitive.half);
+        right = std::max(primitive.x0, primitive.x1) + static_cast<int64_t>(primitive.half);
+        top = std::min(primitive.y0, primitive.y1) - static_cast<int64_t>(primitive.half);
+        bottom = std::max(primitive.y0, primitive.y1) + static_cast<int64_t>(primitive.half);
+    }
+
+    auto saturate = [](int64_t v) {
+        return static_cast<int>(std::clamp<int64_t>(v, std::numeric_limits<int>::min(),
+                                                    std::numeric_limits<int>::max()));
+    };
+    return {saturate(left), saturate(top), saturate(right), saturate(bottom)};
+}
+
+/**
+ * @brief Counts the pixels of a primitive inside a rectangle
+ * @param primitive Primitive
+ * @param rect Rectangle to count in
+ * @return Pixel count
+ */
+uint64_t DisplayList::pixelCount(const Primitive& primitive, const ClipRect& rect) {
+    // Polylines collect their spans before merging them, so huge ones are
+    // counted a strip of rows at a time
+    constexpr int kStripRows = 4096;
+    const ClipRect bounds = DisplayList::bounds(primitive);
+    const int top = std::max(rect.top, bounds.top);
+    const int bottom = std::min(rect.bottom, bounds.bottom);
+
+    uint64_t pixels = 0;
+    for (int64_t y = top; y <= bottom; y += kStripRows) {
+        const ClipRect strip{rect.left, static_cast<int>(y), rect.right,
+                             static_cast<int>(std::min<int64_t>(bottom, y + kStripRows - 1))};
+        forEachSpan(primitive, strip, [&](int, int left, int right) {
+            pixels += static_cast<uint64_t>(right - left) + 1;
+        });
+    }
+    return pixels;
+}
+
+/**
+ * @brief Rasterizes a polyline as the union of its segments
+ * @param p Polyline primitive
+ * @param rect Clip rectangle
+ * @return Merged spans in row order
+ */
+const std::vector<DisplayList::Span>& DisplayList::polylineSpans(const Primitive& p, const ClipRect& rect) {
+    // Reused per thread, tiles rasterize polylines over and over
+    thread_local std::vector<Span> spans;
+    spans.clear();
+
+    auto collect = [&](int y, int left, int right) { spans.push_back({y, left, right}); };
+    if (p.points.size() == 1) {
+        LineRasterizer(p.points[0].first, p.points[0].second, p.points[0].first, p.points[0].second)
+            .forEachSpan(rect, p.half, collect);
+    }
+    for (size_t i = 1; i < p.points.size(); ++i) {
+        LineRasterizer(p.points[i - 1].first, p.points[i - 1].second, p.points[i].first, p.points[i].second)
+            .forEachSpan(rect, p.half, collect);
+    }
+
+    // Segments meeting at a vertex overlap there; merge them into disjoint runs
+    std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) {
+        return a.y != b.y ? a.y < b.y : a.left < b.left;
+    });
+    size_t merged = 0;
+    for (const Span& span : spans) {
+        if (merged > 0 && spans[merged - 1].y == span.y && span.left <= spans[merged - 1].right + 1) {
+            spans[merged - 1].right = std::max(spans[merged - 1].right, span.right);
+        } else {
+            spans[merged++] = span;
+        }
+    }
+    spans.resize(merged);
+    return spans;
+}
+
+/**
+ * @brief Reads primitives from a text file
+ * @param filename Path to the file
+ * @param color Initial color
+ * @param thickness Initial thickness
+ * @return Display list
+ * @throws std::runtime_error on unreadable files or malformed lines
+ */
+DisplayList DisplayList::load(const std::string& filename, BMPFile::Pixel color, unsigned int thickness) {
+    std::ifstream file(filename);
+    if (!file) {
+        throw std::runtime_error("Cannot read display list: " + filename);
+    }
+
+    DisplayList list;
+    std::string line;
+    for (int line_number = 1; std::getline(file, line); ++line_number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream iss(line);
+        std::string command;
+        if (!(iss >> command)) continue;
+
+        auto fail = [&](const std::string& what) {
+            return std::runtime_error(filename + ":" + std::to_string(line_number) + ": " + what);
+        };
+
+        if (command == "color") {
+            std::string text;
+            if (!(iss >> text) || !parseColor(text, color)) throw fail("expected color R,G,B[,A]");
+            continue;
+        }
+        if (command == "thickness") {
+            long value = 0;
+            if (!(iss >> value) || value < 1 || value > LineRasterizer::kMaxCoordinate) {
+                throw fail("expected a thickness from 1 to " + std::to_string(LineRasterizer::kMaxCoordinate));
+            }
+            thickness = static_cast<unsigned int>(value);
+            continue;
+        }
+
+        std::vector<int> values;
+        for (int value; iss >> value;) values.push_back(value);
+        if (!iss.eof()) throw fail("expected integer coordinates");
+        for (int value : values) {
+            if (std::abs(value) > LineRasterizer::kMaxCoordinate) {
+                throw fail("coordinates must lie within +-" + std::to_string(LineRasterizer::kMaxCoordinate));
+            }
+        }
+
+        if (command == "line") {
+            if (values.size() != 4) throw fail("line needs x0 y0 x1 y1");
+            list.addLine(values[0], values[1], values[2], values[3], color, thickness);
+        } else if (command == "rect" || command == "fillrect") {
+            if (values.size() != 4) throw fail(command + " needs x0 y0 x1 y1");
+            list.addRect(values[0], values[1], values[2], values[3], color, thickness, command == "fillrect");
+        } else if (command == "polyline" || command == "polygon") {
+            if (values.empty() || values.size() % 2 != 0) throw fail(command + " needs x y pairs");
+            std::vector<std::pair<int, int>> points;
+            for (size_t i = 0; i < values.size(); i += 2) points.emplace_back(values[i], values[i + 1]);
+            list.addPolyline(points, color, thickness, command == "polygon");
+        } else if (command == "circle" || command == "fillcircle") {
+            if (values.size() != 3 || values[2] < 0) throw fail(command + " needs cx cy r with r >= 0");
+            list.addCircle(values[0], values[1], values[2], color, thickness, command == "fillcircle");
+        } else {
+            throw fail("unknown command '" + command + "'");
+        }
+    }
+
+    return list;
+}
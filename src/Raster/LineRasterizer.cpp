@@ -0,0 +1,116 @@
+/**
+ * @file LineRasterizer.cpp
+ * @brief Implementation of Bresenham setup and clipping
+ */
+
+#include "Raster/LineRasterizer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+
+/**
+ * @brief Normalizes the endpoints the same way the classic loop does
+ */
+LineRasterizer::LineRasterizer(int x0, int y0, int x1, int y1) {
+    steep_ = std::abs(y1 - y0) > std::abs(x1 - x0);
+
+    if (steep_) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    x0_ = x0;
+    y0_ = y0;
+    dx_ = x1 - x0;
+    dy_ = std::abs(y1 - y0);
+    ystep_ = (y0 < y1) ? 1 : -1;
+    e0_ = dx_ / 2;
+}
+
+/**
+ * @brief Finds the steps whose stamps can touch a rectangle
+ * @param rect Clip rectangle
+ * @param half Stamp half-width
+ * @param k_begin Receives first step
+ * @param k_end Receives step after the last one
+ * @return false if nothing is visible
+ */
+bool LineRasterizer::clip(const ClipRect& rect, int half, int& k_begin, int& k_end) const {
+    // Expand the rectangle by the stamp size and express it in line axes
+    const int64_t left = static_cast<int64_t>(rect.left) - half;
+    const int64_t right = static_cast<int64_t>(rect.right) + half;
+    const int64_t top = static_cast<int64_t>(rect.top) - half;
+    const int64_t bottom = static_cast<int64_t>(rect.bottom) + half;
+
+    const int64_t major_lo = steep_ ? top : left;
+    const int64_t major_hi = steep_ ? bottom : right;
+    const int64_t minor_lo = steep_ ? left : top;
+    const int64_t minor_hi = steep_ ? right : bottom;
+
+    // Major axis moves by exactly one per step
+    int64_t lo = std::max<int64_t>(0, major_lo - x0_);
+    int64_t hi = std::min<int64_t>(dx_, major_hi - x0_);
+
+    // Minor axis is monotonic in the step index
+    const int64_t n_lo = ystep_ > 0 ? minor_lo - y0_ : y0_ - minor_hi;
+    const int64_t n_hi = ystep_ > 0 ? minor_hi - y0_ : y0_ - minor_lo;
+    lo = std::max(lo, firstStepReaching(n_lo));
+    hi = std::min(hi, firstStepReaching(n_hi + 1) - 1);
+
+    if (lo > hi) return false;
+    k_begin = static_cast<int>(lo);
+    k_end = static_cast<int>(hi + 1);
+    return true;
+}
+
+/**
+ * @brief Counts the pixels of the thick stroke inside a rectangle
+ * @param rect Rectangle to count in
+ * @param half Stamp half-width
+ * @return Pixel count
+ */
+uint64_t LineRasterizer::strokePixels(const ClipRect& rect, int half) const {
+    uint64_t pixels = 0;
+    forEachSpan(rect, half, [&](int, int left, int right) {
+        pixels += static_cast<uint64_t>(right - left) + 1;
+    });
+    return pixels;
+}
+
+/**
+ * @brief Gets the major-axis extent of the stroke inside a rectangle
+ * @param rect Clip rectangle
+ * @param half Stamp half-width
+ * @param first Receives first major coordinate
+ * @param last Receives last major coordinate
+ * @return false if nothing is visible
+ */
+bool LineRasterizer::majorExtent(const ClipRect& rect, int half, int& first, int& last) const {
+    int k_begin = 0;
+    int k_end = 0;
+    if (!clip(rect, half, k_begin, k_end)) return false;
+
+    first = std::max(steep_ ? rect.top : rect.left, x0_ + k_begin - half);
+    last = std::min(steep_ ? rect.bottom : rect.right, x0_ + k_end - 1 + half);
+    return true;
+}
+
+/**
+ * @brief Finds the first step after at least m minor steps
+ * @param m Required number of minor steps
+ * @return Step index, or steps() if never reached
+ */
+int64_t LineRasterizer::firstStepReaching(int64_t m) const {
+    if (m <= 0) return 0;
+    if (dy_ == 0) return steps();
+
+    // minorSteps(k) >= m  <=>  k * dy > (m - 1) * dx + e0
+    const int64_t k = ((m - 1) * dx_ + e0_) / dy_ + 1;
+    return std::min<int64_t>(k, steps());
+}
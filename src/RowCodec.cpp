@@ -0,0 +1,196 @@
+/**
+ * @file RowCodec.cpp
+ * @brief Scalar and SIMD row converters with runtime dispatch
+ */
+
+#include "RowCodec.hpp"
+#include <cstring>
+
+#if BMP_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using Pixel = BMPFile::Pixel;
+
+void decodeBGR24Scalar(const uint8_t* src, Pixel* dst, int count) {
+    for (int x = 0; x < count; ++x, src += 3) {
+        dst[x].b = src[0];
+        dst[x].g = src[1];
+        dst[x].r = src[2];
+        dst[x].a = 255;
+    }
+}
+
+void encodeBGR24Scalar(const Pixel* src, uint8_t* dst, int count) {
+    for (int x = 0; x < count; ++x, dst += 3) {
+        dst[0] = src[x].b;
+        dst[1] = src[x].g;
+        dst[2] = src[x].r;
+    }
+}
+
+// Pixel is laid out as B, G, R, A, exactly like a BGRA32 file
+void decodeBGRA32(const uint8_t* src, Pixel* dst, int count) {
+    std::memcpy(dst, src, count * sizeof(Pixel));
+}
+
+void encodeBGRA32(const Pixel* src, uint8_t* dst, int count) {
+    std::memcpy(dst, src, count * sizeof(Pixel));
+}
+
+#if BMP_SIMD_X86
+
+BMP_TARGET("ssse3")
+void decodeBGR24SSSE3(const uint8_t* src, Pixel* dst, int count) {
+    const __m128i expand = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128,
+                                         6, 7, 8, -128, 9, 10, 11, -128);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const uint8_t* in = src + x * 3;
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+        const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 32));
+
+        // Realign each group of four 3-byte pixels to the start of a register
+        const __m128i p0 = _mm_shuffle_epi8(v0, expand);
+        const __m128i p1 = _mm_shuffle_epi8(_mm_alignr_epi8(v1, v0, 12), expand);
+        const __m128i p2 = _mm_shuffle_epi8(_mm_alignr_epi8(v2, v1, 8), expand);
+        const __m128i p3 = _mm_shuffle_epi8(_mm_srli_si128(v2, 4), expand);
+
+        __m128i* o = reinterpret_cast<__m128i*>(out + x * 4);
+        _mm_storeu_si128(o, _mm_or_si128(p0, alpha));
+        _mm_storeu_si128(o + 1, _mm_or_si128(p1, alpha));
+        _mm_storeu_si128(o + 2, _mm_or_si128(p2, alpha));
+        _mm_storeu_si128(o + 3, _mm_or_si128(p3, alpha));
+    }
+    decodeBGR24Scalar(src + x * 3, dst + x, count - x);
+}
+
+BMP_TARGET("ssse3")
+void encodeBGR24SSSE3(const Pixel* src, uint8_t* dst, int count) {
+    const __m128i compact = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+                                          -128, -128, -128, -128);
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m128i* i = reinterpret_cast<const __m128i*>(in + x * 4);
+        const __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(i), compact);
+        const __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(i + 1), compact);
+        const __m128i c = _mm_shuffle_epi8(_mm_loadu_si128(i + 2), compact);
+        const __m128i d = _mm_shuffle_epi8(_mm_loadu_si128(i + 3), compact);
+
+        // Stitch four 12-byte groups into three full registers
+        __m128i* o = reinterpret_cast<__m128i*>(dst + x * 3);
+        _mm_storeu_si128(o, _mm_or_si128(a, _mm_slli_si128(b, 12)));
+        _mm_storeu_si128(o + 1, _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+        _mm_storeu_si128(o + 2, _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+    }
+    encodeBGR24Scalar(src + x, dst + x * 3, count - x);
+}
+
+BMP_TARGET("avx2")
+void decodeBGR24AVX2(const uint8_t* src, Pixel* dst, int count) {
+    const __m256i expand = _mm256_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128,
+                                            6, 7, 8, -128, 9, 10, 11, -128,
+                                            0, 1, 2, -128, 3, 4, 5, -128,
+                                            6, 7, 8, -128, 9, 10, 11, -128);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+
+    // Each lane takes four pixels; the last load reads 4 bytes past the block
+    int x = 0;
+    for (; (x + 16) * 3 + 4 <= count * 3; x += 16) {
+        const uint8_t* in = src + x * 3;
+        const __m256i lo = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12)), 1);
+        const __m256i hi = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 24))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 36)), 1);
+
+        __m256i* o = reinterpret_cast<__m256i*>(out + x * 4);
+        _mm256_storeu_si256(o, _mm256_or_si256(_mm256_shuffle_epi8(lo, expand), alpha));
+        _mm256_storeu_si256(o + 1, _mm256_or_si256(_mm256_shuffle_epi8(hi, expand), alpha));
+    }
+    decodeBGR24SSSE3(src + x * 3, dst + x, count - x);
+}
+
+BMP_TARGET("avx2")
+void encodeBGR24AVX2(const Pixel* src, uint8_t* dst, int count) {
+    const __m256i compact = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+                                             -128, -128, -128, -128,
+                                             0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+                                             -128, -128, -128, -128);
+    // Move the upper lane's 12 bytes right behind the lower lane's
+    const __m256i join = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m256i* i = reinterpret_cast<const __m256i*>(in + x * 4);
+        const __m256i a = _mm256_permutevar8x32_epi32(
+            _mm256_shuffle_epi8(_mm256_loadu_si256(i), compact), join);
+        const __m256i b = _mm256_permutevar8x32_epi32(
+            _mm256_shuffle_epi8(_mm256_loadu_si256(i + 1), compact), join);
+
+        // 24 + 24 bytes; the first store's garbage tail is overwritten by the second
+        uint8_t* o = dst + x * 3;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + 24), _mm256_castsi256_si128(b));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(o + 40), _mm256_extracti128_si256(b, 1));
+    }
+    encodeBGR24SSSE3(src + x, dst + x * 3, count - x);
+}
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Gets codec for a specific instruction set
+ * @param isa Requested instruction set
+ * @return Codec, or nullptr if unsupported on this CPU
+ */
+const RowCodec* RowCodec::forIsa(Isa isa) {
+    static const RowCodec scalar(Isa::Scalar, "scalar", decodeBGR24Scalar, encodeBGR24Scalar,
+                                 decodeBGRA32, encodeBGRA32);
+#if BMP_SIMD_X86
+    static const RowCodec ssse3(Isa::SSSE3, "ssse3", decodeBGR24SSSE3, encodeBGR24SSSE3,
+                                decodeBGRA32, encodeBGRA32);
+    static const RowCodec avx2(Isa::AVX2, "avx2", decodeBGR24AVX2, encodeBGR24AVX2,
+                               decodeBGRA32, encodeBGRA32);
+#endif
+
+    if (!CpuFeatures::get().supports(isa)) return nullptr;
+
+    switch (isa) {
+#if BMP_SIMD_X86
+        case Isa::SSSE3:
+            return &ssse3;
+        case Isa::AVX2:
+            return &avx2;
+#endif
+        default:
+            return &scalar;
+    }
+}
+
+/**
+ * @brief Gets the fastest codec supported by the running CPU
+ * @return Codec selected on first call
+ */
+const RowCodec& RowCodec::get() {
+    static const RowCodec& best = [] () -> const RowCodec& {
+        for (Isa isa : {Isa::AVX2, Isa::SSSE3}) {
+            if (const RowCodec* codec = forIsa(isa)) return *codec;
+        }
+        return *forIsa(Isa::Scalar);
+    }();
+    return best;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file Stats.cpp
+ * @brief JSON report of the instrumentation counters
+ */
+
+#include "Stats.hpp"
+#include "ThreadPool.hpp"
+#include <omp.h>
+
+/**
+ * @brief Turns instrumentation on or off and clears all values
+ * @param on New state
+ */
+void Stats::setEnabled(bool on) {
+    for (auto& counter : counters_) counter.store(0, std::memory_order_relaxed);
+    for (auto& nanos : nanos_) nanos.store(0, std::memory_order_relaxed);
+    started_ = std::chrono::steady_clock::now();
+    enabled_.store(on, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Writes all values as a JSON object
+ * @param os Output stream
+ * @param strategy Name of the drawing strategy
+ */
+void Stats::writeJson(std::ostream& os, const std::string& strategy) {
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - started_;
+
+    // Strategy names are plain text, but keep the output valid JSON anyway
+    std::string name;
+    for (char c : strategy) {
+        if (c == '"' || c == '\\') name += '\\';
+        name += c;
+    }
+
+    os << "{\n"
+       << "  \"strategy\": \"" << name << "\",\n"
+       << "  \"threads\": {\"pool\": " << ThreadPool::shared().concurrency()
+       << ", \"openmp\": " << omp_get_max_threads() << "},\n"
+       << "  \"wall_seconds\": " << wall.count() << ",\n"
+       << "  \"stages\": {"
+       << "\"load\": " << seconds(Stage::Load) << ", "
+       << "\"draw\": " << seconds(Stage::Draw) << ", "
+       << "\"threshold\": " << seconds(Stage::Threshold) << ", "
+       << "\"save\": " << seconds(Stage::Save) << ", "
+       << "\"display\": " << seconds(Stage::Display) << "},\n"
+       << "  \"bytes_read\": " << get(Counter::BytesRead) << ",\n"
+       << "  \"bytes_written\": " << get(Counter::BytesWritten) << ",\n"
+       << "  \"pixels_touched\": " << get(Counter::PixelsTouched) << ",\n"
+       << "  \"pixels_clipped\": " << get(Counter::PixelsClipped) << ",\n"
+       << "  \"buffers\": {\"allocated\": " << get(Counter::BufferAllocations)
+       << ", \"reused\": " << get(Counter::BufferReuses) << "}\n"
+       << "}\n";
+}
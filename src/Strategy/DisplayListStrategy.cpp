@@ -0,0 +1,138 @@
+#include "Strategy/DisplayListStrategy.hpp"
+#include "Raster/SpanPainter.hpp"
+#include "BinaryRaster.hpp"
+#include "ThresholdKernel.hpp"
+#include "ThreadPool.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace {
+
+/// Tile width in pixels; a 32-bit tile row fills eight cache lines
+constexpr int kTileWidth = 128;
+
+/// Tile height in rows; a whole 32-bit tile stays within L1
+constexpr int kTileHeight = 64;
+
+} // namespace
+
+DisplayListStrategy::DisplayListStrategy(std::shared_ptr<const DisplayList> list, bool parallel)
+    : list_(std::move(list)), parallel_(parallel) {}
+
+void DisplayListStrategy::drawBand(BMPFile& image, const Band& band) {
+    const ClipRect area{0, band.first_row, band.canvas_width - 1, band.last_row - 1};
+    if (!list_ || list_->empty() || area.left > area.right || area.top > area.bottom) return;
+
+    const int tiles_x = (band.canvas_width + kTileWidth - 1) / kTileWidth;
+    const int tiles_y = (band.last_row - band.first_row + kTileHeight - 1) / kTileHeight;
+    const auto& primitives = list_->primitives();
+
+    // Bin primitive indices by the tiles their bounds overlap, keeping list order
+    std::vector<std::vector<uint32_t>> bins(static_cast<size_t>(tiles_x) * tiles_y);
+    for (size_t i = 0; i < primitives.size(); ++i) {
+        const ClipRect bounds = DisplayList::bounds(primitives[i]);
+        const int left = std::max(bounds.left, area.left);
+        const int right = std::min(bounds.right, area.right);
+        const int top = std::max(bounds.top, area.top);
+        const int bottom = std::min(bounds.bottom, area.bottom);
+        if (left > right || top > bottom) continue;
+
+        for (int ty = (top - area.top) / kTileHeight; ty <= (bottom - area.top) / kTileHeight; ++ty) {
+            for (int tx = left / kTileWidth; tx <= right / kTileWidth; ++tx) {
+                bins[static_cast<size_t>(ty) * tiles_x + tx].push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    std::vector<size_t> busy;
+    for (size_t t = 0; t < bins.size(); ++t) {
+        if (!bins[t].empty()) busy.push_back(t);
+    }
+
+    const BMPFile::RowLayout layout = image.rowLayout();
+    std::atomic<uint64_t> drawn{0};
+    auto drawTile = [&](size_t n) {
+        const size_t t = busy[n];
+        const int tx = static_cast<int>(t % tiles_x);
+        const int ty = static_cast<int>(t / tiles_x);
+        const ClipRect tile{tx * kTileWidth, area.top + ty * kTileHeight,
+                            std::min(area.right, (tx + 1) * kTileWidth - 1),
+                            std::min(area.bottom, area.top + (ty + 1) * kTileHeight - 1)};
+
+        uint64_t tile_drawn = 0;
+        for (uint32_t index : bins[t]) {
+            const DisplayList::Primitive& primitive = primitives[index];
+            withSpanPainter(layout, primitive.color, [&](const auto& paint) {
+                DisplayList::forEachSpan(primitive, tile, [&](int y, int left, int right) {
+                    paint(y - band.row_offset, left, right);
+                    tile_drawn += right - left + 1;
+                });
+            });
+        }
+        drawn.fetch_add(tile_drawn, std::memory_order_relaxed);
+    };
+
+    if (parallel_) {
+        ThreadPool::shared().run(busy.size(), drawTile);
+    } else {
+        for (size_t n = 0; n < busy.size(); ++n) drawTile(n);
+    }
+
+    if (Stats::enabled()) Stats::addStroke(strokePixels(band.statsArea()), drawn);
+}
+
+uint64_t DisplayListStrategy::strokePixels(const ClipRect& area) const {
+    uint64_t pixels = 0;
+    for (const DisplayList::Primitive& primitive : list_->primitives()) {
+        pixels += DisplayList::pixelCount(primitive, area);
+    }
+    return pixels;
+}
+
+bool DisplayListStrategy::canDrawBinary() const {
+    if (!list_) return true;
+    const auto& primitives = list_->primitives();
+    return std::all_of(primitives.begin(), primitives.end(),
+                       [](const DisplayList::Primitive& primitive) { return primitive.color.a == 255; });
+}
+
+void DisplayListStrategy::drawBinary(BinaryRaster& raster) {
+    const ClipRect area{0, 0, raster.width() - 1, raster.height() - 1};
+    if (!list_ || area.left > area.right || area.top > area.bottom) return;
+
+    uint64_t drawn = 0;
+    for (const DisplayList::Primitive& primitive : list_->primitives()) {
+        const bool white = ThresholdKernel::isWhite(primitive.color.r, primitive.color.g, primitive.color.b);
+        DisplayList::forEachSpan(primitive, area, [&](int y, int left, int right) {
+            raster.fillSpan(y, left, right, white);
+            drawn += right - left + 1;
+        });
+    }
+
+    if (Stats::enabled()) {
+        const Band whole{raster.width(), raster.height(), 0, 0, raster.height()};
+        Stats::addStroke(strokePixels(whole.statsArea()), drawn);
+    }
+}
+
+std::string DisplayListStrategy::getName() const {
+    return std::string("Display List Strategy (") + (parallel_ ? "Tiled, thread pool" : "Tiled, single-threaded") + ")";
+}
+
+void DisplayListStrategy::setColor(const BMPFile::Pixel& color) {
+    color_ = color;
+}
+
+BMPFile::Pixel DisplayListStrategy::getColor() const {
+    return color_;
+}
+
+void DisplayListStrategy::setThickness(unsigned int thickness) {
+    thickness_ = std::max(1u, thickness);
+}
+
+unsigned int DisplayListStrategy::getThickness() const {
+    return thickness_;
+}
@@ -1,67 +1,57 @@
 #include "Strategy/DrawCrossOpenMPStrategy.hpp"
+#include "Strategy/DrawCrossStrategy.hpp"
+#include "Raster/RowBandScheduler.hpp"
+#include "Raster/SpanPainter.hpp"
+#include "Stats.hpp"
+#include <algorithm>
 
-void DrawCrossOpenMPStrategy::draw(BMPFile& image) {
-    const int width = image.width();
-    const int height = image.height();
-    
-    // Draw cross
-    drawLine(image, 0, 0, width - 1, height - 1); // Vertical
-    drawLine(image, 0, height - 1, width - 1, 0); // Horizontal
-}
-
-void DrawCrossOpenMPStrategy::drawLine(BMPFile& image, int x0, int y0, int x1, int y1) {
-    bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
-
-    if (steep) {
-        std::swap(x0, y0);
-        std::swap(x1, y1);
-    }
-
-    if (x0 > x1) {
-        std::swap(x0, x1);
-        std::swap(y0, y1);
-    }
-
-    const int dx = x1 - x0;
-    const int dy = std::abs(y1 - y0);
-    int error = dx / 2;
-    const int ystep = (y0 < y1) ? 1 : -1;
-    int y = y0;
+void DrawCrossOpenMPStrategy::drawBand(BMPFile& image, const Band& band) {
+    const int width = band.canvas_width;
+    const int height = band.canvas_height;
+    const int half = static_cast<int>(thickness_) / 2;
 
-    std::vector<std::pair<int, int>> pixels;
-    pixels.reserve(dx + 1);
-
-    for (int x = x0; x <= x1; x++) {
-        pixels.emplace_back(steep ? y : x, steep ? x : y);
-        error -= dy;
-        if (error < 0) {
-            y += ystep;
-            error += dx;
+    // Draw cross
+    const LineRasterizer lines[] = {
+        {0, 0, width - 1, height - 1}, // Vertical
+        {0, height - 1, width - 1, 0}  // Horizontal
+    };
+
+    // One row band per thread, each drawing every line clipped to its rows
+    const RowBandScheduler scheduler(band.first_row, band.last_row, omp_get_max_threads());
+    uint64_t drawn = 0;
+
+    withSpanPainter(image, color_, [&](const auto& paint) {
+        uint64_t painted = 0;
+
+        #pragma omp parallel for schedule(static, 1) reduction(+:painted)
+        for (int i = 0; i < scheduler.bands(); ++i) {
+            const ClipRect clip = scheduler.band(i, 0, width - 1);
+            for (const auto& line : lines) {
+                painted += drawLine(paint, band, clip, line);
+            }
         }
-    }
+        drawn = painted;
+    });
 
-    // Parallel pixel drawing
-    #pragma omp parallel for schedule(static)
-    for (size_t i = 0; i < pixels.size(); ++i) {
-        drawThickPixel(image, pixels[i].first, pixels[i].second);
+    if (Stats::enabled()) {
+        const ClipRect area = band.statsArea();
+        Stats::addStroke(lines[0].strokePixels(area, half) + lines[1].strokePixels(area, half), drawn);
     }
 }
 
-void DrawCrossOpenMPStrategy::drawThickPixel(BMPFile& image, int x, int y) {
-    if (thickness_ == 1) {
-        try {
-            image.setPixel(x, y, color_);
-        } catch (const std::out_of_range&) {}
-        return;
-    }
+template <typename Painter>
+uint64_t DrawCrossOpenMPStrategy::drawLine(const Painter& paint, const Band& band, const ClipRect& clip,
+                                           const LineRasterizer& line) {
+    const int half = static_cast<int>(thickness_) / 2;
+
+    uint64_t drawn = 0;
+    line.forEachSpan(clip, half, [&](int y, int left, int right) {
+        paint(y - band.row_offset, left, right);
+        drawn += right - left + 1;
+    });
+    return drawn;
+}
 
-    const int half = thickness_ / 2;
-    #pragma omp parallel for collapse(2) schedule(static)
-    for (int dy = -half; dy <= half; ++dy) {
-        for (int dx = -half; dx <= half; ++dx) {
-            try {
-                image.setPixel(x + dx, y + dy, color_);
-            } catch (const std::out_of_range&) {}
-        }
-    }
-}
\ No newline at end of file
+void DrawCrossOpenMPStrategy::drawBinary(BinaryRaster& raster) {
+    DrawCrossStrategy::drawCross(raster, color_, thickness_);
+}
@@ -1,15 +1,42 @@
 #include "Strategy/DrawCrossStrategy.hpp"
+#include "Raster/LineRasterizer.hpp"
+#include "Raster/SpanPainter.hpp"
+#include "BinaryRaster.hpp"
+#include "ThresholdKernel.hpp"
+#include "Stats.hpp"
+#include <algorithm>
 
 DrawCrossStrategy::DrawCrossStrategy(BMPFile::Pixel color, unsigned int thickness)
     : color_(color), thickness_(std::max(1u, thickness)) {}
 
-void DrawCrossStrategy::draw(BMPFile& image) {
-    const int width = image.width();
-    const int height = image.height();
+void DrawCrossStrategy::drawBand(BMPFile& image, const Band& band) {
+    const int width = band.canvas_width;
+    const int height = band.canvas_height;
     
     // Draw cross
-    drawLine(image, 0, 0, width - 1, height - 1); // Vertical
-    drawLine(image, 0, height - 1, width - 1, 0); // Horizontal
+    drawLine(image, band, 0, 0, width - 1, height - 1); // Vertical
+    drawLine(image, band, 0, height - 1, width - 1, 0); // Horizontal
+}
+
+void DrawCrossStrategy::drawBinary(BinaryRaster& raster) {
+    drawCross(raster, color_, thickness_);
+}
+
+void DrawCrossStrategy::drawCross(BinaryRaster& raster, BMPFile::Pixel color, unsigned int thickness) {
+    const int width = raster.width();
+    const int height = raster.height();
+    const bool white = ThresholdKernel::isWhite(color.r, color.g, color.b);
+
+    // Same lines as drawBand, thresholded once instead of per pixel
+    uint64_t drawn = raster.drawLine(0, 0, width - 1, height - 1, thickness, white);
+    drawn += raster.drawLine(0, height - 1, width - 1, 0, thickness, white);
+
+    if (Stats::enabled()) {
+        const int half = static_cast<int>(std::max(1u, thickness)) / 2;
+        const ClipRect area = Band{width, height, 0, 0, height}.statsArea();
+        Stats::addStroke(LineRasterizer(0, 0, width - 1, height - 1).strokePixels(area, half) +
+                         LineRasterizer(0, height - 1, width - 1, 0).strokePixels(area, half), drawn);
+    }
 }
 
 std::string DrawCrossStrategy::getName() const {
@@ -32,53 +59,19 @@ unsigned int DrawCrossStrategy::getThickness() const {
     return thickness_;
 }
 
-void DrawCrossStrategy::drawLine(BMPFile& image, int x0, int y0, int x1, int y1) {
-    bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
-    
-    if (steep) {
-        std::swap(x0, y0);
-        std::swap(x1, y1);
-    }
-    
-    if (x0 > x1) {
-        std::swap(x0, x1);
-        std::swap(y0, y1);
-    }
-    
-    const int dx = x1 - x0;
-    const int dy = std::abs(y1 - y0);
-    int error = dx / 2;
-    const int ystep = (y0 < y1) ? 1 : -1;
-    int y = y0;
-    
-    for (int x = x0; x <= x1; x++) {
-        drawThickPixel(image, steep ? y : x, steep ? x : y);
-        error -= dy;
-        if (error < 0) {
-            y += ystep;
-            error += dx;
-        }
-    }
-}
+void DrawCrossStrategy::drawLine(BMPFile& image, const Band& band, int x0, int y0, int x1, int y1) {
+    // Stroke spans clipped to the image columns and the band rows
+    const int half = static_cast<int>(thickness_) / 2;
+    const ClipRect clip{0, band.first_row, band.canvas_width - 1, band.last_row - 1};
+    const LineRasterizer line(x0, y0, x1, y1);
 
-void DrawCrossStrategy::drawThickPixel(BMPFile& image, int x, int y) {
-    if (thickness_ == 1) {
-        try {
-            image.setPixel(x, y, color_);
-        } catch (const std::out_of_range&) {
-            // Silently ignore out-of-bounds pixels
-        }
-        return;
-    }
-    
-    const int half = thickness_ / 2;
-    for (int dy = -half; dy <= half; ++dy) {
-        for (int dx = -half; dx <= half; ++dx) {
-            try {
-                image.setPixel(x + dx, y + dy, color_);
-            } catch (const std::out_of_range&) {
-                // Silently ignore out-of-bounds pixels
-            }
-        }
-    }
-}
\ No newline at end of file
+    uint64_t drawn = 0;
+    withSpanPainter(image, color_, [&](const auto& paint) {
+        line.forEachSpan(clip, half, [&](int y, int left, int right) {
+            paint(y - band.row_offset, left, right);
+            drawn += right - left + 1;
+        });
+    });
+
+    if (Stats::enabled()) Stats::addStroke(line.strokePixels(band.statsArea(), half), drawn);
+}
@@ -1,15 +1,33 @@
 #include "Strategy/DrawCrossThreadStrategy.hpp"
+#include "Strategy/DrawCrossStrategy.hpp"
+#include "Raster/LineRasterizer.hpp"
+#include "Raster/SpanPainter.hpp"
+#include "ThreadPool.hpp"
+#include "Stats.hpp"
+#include <atomic>
+#include <algorithm>
+
+namespace {
+
+/// Smallest major-axis slab worth a pool task
+constexpr int kMinSlabSteps = 64;
+
+} // namespace
 
 DrawCrossThreadStrategy::DrawCrossThreadStrategy(BMPFile::Pixel color, unsigned int thickness)
     : color_(color), thickness_(std::max(1u, thickness)) {}
 
-void DrawCrossThreadStrategy::draw(BMPFile& image) {
-    const int width = image.width();
-    const int height = image.height();
+void DrawCrossThreadStrategy::drawBand(BMPFile& image, const Band& band) {
+    const int width = band.canvas_width;
+    const int height = band.canvas_height;
     
     // Draw cross
-    drawLine(image, 0, 0, width - 1, height - 1); // Vertical
-    drawLine(image, 0, height - 1, width - 1, 0); // Horizontal
+    drawLine(image, band, 0, 0, width - 1, height - 1); // Vertical
+    drawLine(image, band, 0, height - 1, width - 1, 0); // Horizontal
+}
+
+void DrawCrossThreadStrategy::drawBinary(BinaryRaster& raster) {
+    DrawCrossStrategy::drawCross(raster, color_, thickness_);
 }
 
 std::string DrawCrossThreadStrategy::getName() const {
@@ -32,72 +50,29 @@ unsigned int DrawCrossThreadStrategy::getThickness() const {
     return thickness_;
 }
 
-void DrawCrossThreadStrategy::drawLine(BMPFile& image, int x0, int y0, int x1, int y1) {
-    bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
-    
-    if (steep) {
-        std::swap(x0, y0);
-        std::swap(x1, y1);
-    }
-    
-    if (x0 > x1) {
-        std::swap(x0, x1);
-        std::swap(y0, y1);
-    }
-    
-    const int dx = x1 - x0;
-    const int dy = std::abs(y1 - y0);
-    const int ystep = (y0 < y1) ? 1 : -1;
-    
-    // Determine optimal number of threads
-    const unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
-    const int chunk_size = std::max(1, dx / static_cast<int>(num_threads));
-    
-    std::vector<std::thread> threads;
-    threads.reserve(num_threads);
-    
-    for (unsigned t = 0; t < num_threads; ++t) {
-        const int start = x0 + t * chunk_size;
-        const int end = (t == num_threads - 1) ? x1 : start + chunk_size;
-        
-        threads.emplace_back([=, &image]() {
-            int y = y0;
-            int error = dx / 2;
-            
-            for (int x = start; x <= end; x++) {
-                drawThickPixelArea(image, steep ? y : x, steep ? x : y);
-                error -= dy;
-                if (error < 0) {
-                    y += ystep;
-                    error += dx;
-                }
-            }
+void DrawCrossThreadStrategy::drawLine(BMPFile& image, const Band& band, int x0, int y0, int x1, int y1) {
+    // Stroke spans clipped to the image columns and the band rows
+    const int half = static_cast<int>(thickness_) / 2;
+    const ClipRect clip{0, band.first_row, band.canvas_width - 1, band.last_row - 1};
+    const LineRasterizer line(x0, y0, x1, y1);
+
+    std::atomic<uint64_t> drawn{0};
+    int first = 0;
+    int last = 0;
+    if (line.majorExtent(clip, half, first, last)) {
+        // Slabs along the major axis hold equal numbers of steps whatever the
+        // slope, and each one seeds its Bresenham state in closed form
+        withSpanPainter(image, color_, [&](const auto& paint) {
+            ThreadPool::shared().parallelFor(first, last + 1, kMinSlabSteps, [&](int begin, int end) {
+                uint64_t slab_drawn = 0;
+                line.forEachSpan(line.majorSlab(clip, begin, end - 1), half, [&](int y, int left, int right) {
+                    paint(y - band.row_offset, left, right);
+                    slab_drawn += right - left + 1;
+                });
+                drawn.fetch_add(slab_drawn, std::memory_order_relaxed);
+            });
         });
     }
-    
-    for (auto& thread : threads) {
-        thread.join();
-    }
-}
 
-void DrawCrossThreadStrategy::drawThickPixel(BMPFile& image, int x, int y) {
-    try {
-        image.setPixel(x, y, color_);
-    } catch (const std::out_of_range&) {
-        // Silently ignore out-of-bounds pixels
-    }
+    if (Stats::enabled()) Stats::addStroke(line.strokePixels(band.statsArea(), half), drawn);
 }
-
-void DrawCrossThreadStrategy::drawThickPixelArea(BMPFile& image, int x, int y) {
-    if (thickness_ == 1) {
-        drawThickPixel(image, x, y);
-        return;
-    }
-    
-    const int half = thickness_ / 2;
-    for (int dy = -half; dy <= half; ++dy) {
-        for (int dx = -half; dx <= half; ++dx) {
-            drawThickPixel(image, x + dx, y + dy);
-        }
-    }
-}
\ No newline at end of file
@@ -0,0 +1,170 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief Implementation of the work-stealing thread pool
+ */
+
+#include "ThreadPool.hpp"
+#include <exception>
+
+namespace {
+
+/// Index of the pool worker running on this thread, or npos outside workers
+thread_local size_t tls_worker = static_cast<size_t>(-1);
+
+/**
+ * @struct Batch
+ * @brief Completion state of one run() call
+ */
+struct Batch {
+    const std::function<void(size_t)>* task = nullptr;
+    std::atomic<size_t> remaining{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+
+    /**
+     * @brief Runs one task and counts it as finished
+     * @param i Task index
+     */
+    void execute(size_t i) {
+        try {
+            (*task)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+        }
+
+        // Decrement under the lock so the batch outlives the last notification
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--remaining == 0) done.notify_all();
+    }
+};
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned workers) {
+    queues_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+
+    workers_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) {
+        workers_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Gets pool shared by the whole process
+ * @return Pool with one worker less than the hardware threads
+ */
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+/**
+ * @brief Runs a batch of tasks and waits for it
+ * @param count Number of tasks
+ * @param task Task body, called with the task index
+ */
+void ThreadPool::run(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) return;
+
+    // Without workers, or for a single task, queuing only adds overhead
+    if (queues_.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+
+    Batch batch;
+    batch.task = &task;
+    batch.remaining = count;
+
+    pending_ += count;
+
+    // Nested batches stay on the submitting worker and get stolen from there
+    const bool on_worker = tls_worker < queues_.size();
+    for (size_t i = 0; i < count; ++i) {
+        const size_t target = on_worker ? tls_worker : next_queue_++ % queues_.size();
+        Queue& queue = *queues_[target];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        // Two words fit std::function's inline storage, so queuing does not allocate
+        queue.tasks.emplace_back([&batch, i] { batch.execute(i); });
+    }
+
+    // Taking the lock orders the wake-up after any worker's predicate check
+    { std::lock_guard<std::mutex> lock(wake_mutex_); }
+    wake_.notify_all();
+
+    // Help until the queues are empty, then wait for tasks still running
+    const size_t preferred = on_worker ? tls_worker : 0;
+    while (batch.remaining > 0 && runOne(preferred)) {}
+
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.done.wait(lock, [&batch] { return batch.remaining == 0; });
+
+    if (batch.error) std::rethrow_exception(batch.error);
+}
+
+/**
+ * @brief Body of a worker thread
+ * @param index Worker index
+ */
+void ThreadPool::workerLoop(size_t index) {
+    tls_worker = index;
+
+    for (;;) {
+        if (runOne(index)) continue;
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_.wait(lock, [this] { return stop_ || pending_ > 0; });
+        if (stop_ && pending_ == 0) return;
+    }
+}
+
+/**
+ * @brief Runs one queued task
+ * @param preferred Deque to pop from the back first
+ * @return true if a task was run, false if all deques were empty
+ */
+bool ThreadPool::runOne(size_t preferred) {
+    std::function<void()> task;
+
+    {
+        Queue& own = *queues_[preferred];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+
+    // Steal the oldest task of another worker
+    for (size_t i = 1; !task && i < queues_.size(); ++i) {
+        Queue& victim = *queues_[(preferred + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+
+    if (!task) return false;
+
+    --pending_;
+    task();
+    return true;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file ThresholdKernel.cpp
+ * @brief Scalar and SIMD black and white threshold kernels
+ */
+
+#include "ThresholdKernel.hpp"
+
+#if BMP_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using Pixel = BMPFile::Pixel;
+
+void thresholdScalar(Pixel* pixels, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        Pixel& p = pixels[i];
+        const uint8_t value = ThresholdKernel::isWhite(p.r, p.g, p.b) ? 255 : 0;
+        p.b = p.g = p.r = value;
+    }
+}
+
+void thresholdBGR24Scalar(uint8_t* bytes, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t* p = bytes + i * 3;
+        const uint8_t value = ThresholdKernel::isWhite(p[2], p[1], p[0]) ? 255 : 0;
+        p[0] = p[1] = p[2] = value;
+    }
+}
+
+#if BMP_SIMD_X86
+
+// Pixels hold B, G, R, A bytes; after widening to 16 bits, pmaddwd yields
+// B*114 + G*587 and R*299 + A*0, and phaddd adds the pair per pixel.
+
+BMP_TARGET("ssse3")
+void thresholdSSSE3(Pixel* pixels, size_t count) {
+    const __m128i weights = _mm_setr_epi16(ThresholdKernel::kWeightB, ThresholdKernel::kWeightG,
+                                           ThresholdKernel::kWeightR, 0,
+                                           ThresholdKernel::kWeightB, ThresholdKernel::kWeightG,
+                                           ThresholdKernel::kWeightR, 0);
+    const __m128i tie = _mm_set1_epi32(ThresholdKernel::kTie);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i white = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i* p = reinterpret_cast<__m128i*>(pixels + i);
+        const __m128i v0 = _mm_loadu_si128(p);
+        const __m128i v1 = _mm_loadu_si128(p + 1);
+
+        const __m128i luma0 = _mm_hadd_epi32(
+            _mm_madd_epi16(_mm_unpacklo_epi8(v0, zero), weights),
+            _mm_madd_epi16(_mm_unpackhi_epi8(v0, zero), weights));
+        const __m128i luma1 = _mm_hadd_epi32(
+            _mm_madd_epi16(_mm_unpacklo_epi8(v1, zero), weights),
+            _mm_madd_epi16(_mm_unpackhi_epi8(v1, zero), weights));
+
+        const __m128i ties = _mm_or_si128(_mm_cmpeq_epi32(luma0, tie), _mm_cmpeq_epi32(luma1, tie));
+        if (_mm_movemask_epi8(ties)) {
+            thresholdScalar(pixels + i, 8);
+            continue;
+        }
+
+        _mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(v0, alpha),
+                                         _mm_and_si128(_mm_cmpgt_epi32(luma0, tie), white)));
+        _mm_storeu_si128(p + 1, _mm_or_si128(_mm_and_si128(v1, alpha),
+                                             _mm_and_si128(_mm_cmpgt_epi32(luma1, tie), white)));
+    }
+    thresholdScalar(pixels + i, count - i);
+}
+
+// Scaled luma of four BGR0 pixels
+BMP_TARGET("ssse3")
+inline __m128i lumaSSSE3(__m128i pixels, __m128i weights) {
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_hadd_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights),
+                          _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights));
+}
+
+BMP_TARGET("ssse3")
+void thresholdBGR24SSSE3(uint8_t* bytes, size_t count) {
+    const __m128i weights = _mm_setr_epi16(ThresholdKernel::kWeightB, ThresholdKernel::kWeightG,
+                                           ThresholdKernel::kWeightR, 0,
+                                           ThresholdKernel::kWeightB, ThresholdKernel::kWeightG,
+                                           ThresholdKernel::kWeightR, 0);
+    const __m128i expand = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128,
+                                         6, 7, 8, -128, 9, 10, 11, -128);
+    const __m128i spread = _mm_setr_epi8(0, 0, 0, 4, 4, 4, 8, 8, 8, 12, 12, 12,
+                                         -128, -128, -128, -128);
+    const __m128i tie = _mm_set1_epi32(ThresholdKernel::kTie);
+
+    // Sixteen pixels fill three registers; each group of four is realigned
+    // to BGR0 for the luma and its result spread back over 12 bytes
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i* p = reinterpret_cast<__m128i*>(bytes + i * 3);
+        const __m128i v0 = _mm_loadu_si128(p);
+        const __m128i v1 = _mm_loadu_si128(p + 1);
+        const __m128i v2 = _mm_loadu_si128(p + 2);
+
+        const __m128i luma0 = lumaSSSE3(_mm_shuffle_epi8(v0, expand), weights);
+        const __m128i luma1 = lumaSSSE3(_mm_shuffle_epi8(_mm_alignr_epi8(v1, v0, 12), expand), weights);
+        const __m128i luma2 = lumaSSSE3(_mm_shuffle_epi8(_mm_alignr_epi8(v2, v1, 8), expand), weights);
+        const __m128i luma3 = lumaSSSE3(_mm_shuffle_epi8(_mm_srli_si128(v2, 4), expand), weights);
+
+        const __m128i ties = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(luma0, tie), _mm_cmpeq_epi32(luma1, tie)),
+                                          _mm_or_si128(_mm_cmpeq_epi32(luma2, tie), _mm_cmpeq_epi32(luma3, tie)));
+        if (_mm_movemask_epi8(ties)) {
+            thresholdBGR24Scalar(bytes + i * 3, 16);
+            continue;
+        }
+
+        const __m128i a = _mm_shuffle_epi8(_mm_cmpgt_epi32(luma0, tie), spread);
+        const __m128i b = _mm_shuffle_epi8(_mm_cmpgt_epi32(luma1, tie), spread);
+        const __m128i c = _mm_shuffle_epi8(_mm_cmpgt_epi32(luma2, tie), spread);
+        const __m128i d = _mm_shuffle_epi8(_mm_cmpgt_epi32(luma3, tie), spread);
+        _mm_storeu_si128(p, _mm_or_si128(a, _mm_slli_si128(b, 12)));
+        _mm_storeu_si128(p + 1, _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+        _mm_storeu_si128(p + 2, _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+    }
+    thresholdBGR24Scalar(bytes + i * 3, count - i);
+}
+
+BMP_TARGET("avx2")
+void thresholdAVX2(Pixel* pixels, size_t count) {
+    const __m256i weights = _mm256_setr_epi16(
+        ThresholdKernel::kWeightB, ThresholdKernel::kWeightG, ThresholdKernel::kWeightR, 0,
+        ThresholdKernel::kWeightB, ThresholdKernel::kWeightG, ThresholdKernel::kWeightR, 0,
+        ThresholdKernel::kWeightB, ThresholdKernel::kWeightG, ThresholdKernel::kWeightR, 0,
+        ThresholdKernel::kWeightB, ThresholdKernel::kWeightG, ThresholdKernel::kWeightR, 0);
+    const __m256i tie = _mm256_set1_epi32(ThresholdKernel::kTie);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256i white = _mm256_set1_epi32(0x00FFFFFF);
+    const __m256i zero = _mm256_setzero_si256();
+
+    // Unpack and hadd stay within 128-bit lanes, which keeps pixel order
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i* p = reinterpret_cast<__m256i*>(pixels + i);
+        const __m256i v0 = _mm256_loadu_si256(p);
+        const __m256i v1 = _mm256_loadu_si256(p + 1);
+
+        const __m256i luma0 = _mm256_hadd_epi32(
+            _mm256_madd_epi16(_mm256_unpacklo_epi8(v0, zero), weights),
+            _mm256_madd_epi16(_mm256_unpackhi_epi8(v0, zero), weights));
+        const __m256i luma1 = _mm256_hadd_epi32(
+            _mm256_madd_epi16(_mm256_unpacklo_epi8(v1, zero), weights),
+            _mm256_madd_epi16(_mm256_unpackhi_epi8(v1, zero), weights));
+
+        const __m256i ties = _mm256_or_si256(_mm256_cmpeq_epi32(luma0, tie),
+                                             _mm256_cmpeq_epi32(luma1, tie));
+        if (!_mm256_testz_si256(ties, ties)) {
+            thresholdScalar(pixels + i, 16);
+            continue;
+        }
+
+        _mm256_storeu_si256(p, _mm256_or_si256(_mm256_and_si256(v0, alpha),
+                                               _mm256_and_si256(_mm256_cmpgt_epi32(luma0, tie), white)));
+        _mm256_storeu_si256(p + 1, _mm256_or_si256(_mm256_and_si256(v1, alpha),
+                                                   _mm256_and_si256(_mm256_cmpgt_epi32(luma1, tie), white)));
+    }
+    thresholdSSSE3(pixels + i, count - i);
+}
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Gets kernel for a specific instruction set
+ * @param isa Requested instruction set
+ * @return Kernel, or nullptr if unsupported on this CPU
+ */
+const ThresholdKernel* ThresholdKernel::forIsa(Isa isa) {
+    static const ThresholdKernel scalar(Isa::Scalar, "scalar", thresholdScalar, thresholdBGR24Scalar);
+#if BMP_SIMD_X86
+    // 3-byte pixels do not split evenly across 256-bit lanes, so packed
+    // rows use the SSSE3 loop under AVX2 as well
+    static const ThresholdKernel ssse3(Isa::SSSE3, "ssse3", thresholdSSSE3, thresholdBGR24SSSE3);
+    static const ThresholdKernel avx2(Isa::AVX2, "avx2", thresholdAVX2, thresholdBGR24SSSE3);
+#endif
+
+    if (!CpuFeatures::get().supports(isa)) return nullptr;
+
+    switch (isa) {
+#if BMP_SIMD_X86
+        case Isa::SSSE3:
+            return &ssse3;
+        case Isa::AVX2:
+            return &avx2;
+#endif
+        default:
+            return &scalar;
+    }
+}
+
+/**
+ * @brief Gets the fastest kernel supported by the running CPU
+ * @return Kernel selected on first call
+ */
+const ThresholdKernel& ThresholdKernel::get() {
+    static const ThresholdKernel& best = [] () -> const ThresholdKernel& {
+        for (Isa isa : {Isa::AVX2, Isa::SSSE3}) {
+            if (const ThresholdKernel* kernel = forIsa(isa)) return *kernel;
+        }
+        return *forIsa(Isa::Scalar);
+    }();
+    return best;
+}
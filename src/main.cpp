@@ -1,6 +1,29 @@
 #include <iostream>
+#include <fstream>
 #include "BMPProcessor.hpp"
+#include "BatchProcessor.hpp"
 #include "DrawStrategyFactory.hpp"
+#include "Stats.hpp"
+
+/**
+ * @brief Write the --stats report if one was requested
+ * @param config Parsed configuration
+ * @param strategy_name Name of the drawing strategy used
+ */
+static void writeStats(const BMPProcessor::Config& config, const std::string& strategy_name) {
+    if (config.stats_file.empty()) return;
+
+    if (config.stats_file == "-") {
+        Stats::writeJson(std::cout, strategy_name);
+        return;
+    }
+
+    std::ofstream out(config.stats_file);
+    Stats::writeJson(out, strategy_name);
+    if (!out) {
+        std::cerr << "Warning: cannot write stats to '" << config.stats_file << "'\n";
+    }
+}
 
 /**
  * @brief Main entry point for BMP image processing application
@@ -15,27 +38,48 @@ int main(int argc, char* argv[]) {
     try {
         // 1. Parse command line arguments
         BMPProcessor::Config config = BMPProcessor::Config::parse(argc, argv);
+        if (!config.stats_file.empty()) {
+            Stats::setEnabled(true);
+        }
         
+        // Stats written to stdout replace the usual report so it stays valid JSON
+        const bool report = config.stats_file != "-";
+
+        // Batch mode runs the whole job list without console preview
+        if (config.isBatch()) {
+            BatchProcessor batch(config);
+            const bool ok = batch.run();
+            if (report) {
+                std::cout << "Processed " << batch.jobs() - batch.failed() << " of "
+                          << batch.jobs() << " images\n";
+            }
+            writeStats(config, config.createStrategy()->getName());
+            return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
         // 2. Create and configure drawing strategy
-        auto strategy = DrawStrategyFactory::create(config.strategy_type);
-        strategy->setColor(config.color);
-        strategy->setThickness(config.thickness);
+        auto strategy = config.createStrategy();
+        const std::string strategy_name = strategy->getName();
 
         // 3. Initialize processor with configuration and strategy
         BMPProcessor processor(config, std::move(strategy));
 
         // 4. Execute image processing pipeline
-        if (processor.process()) {
+        const bool ok = processor.process();
+        if (ok && report) {
             std::cout << "Success: Image processed and saved to '" 
                       << config.output_file << "'\n";
             
             // 5. Display processed image if successful
             processor.display();
-        } else {
+        } else if (!ok) {
             std::cerr << "Error: Failed to process image\n";
-            return EXIT_FAILURE;
         }
 
+        // Stats are most useful when processing failed, so they are always written
+        writeStats(config, strategy_name);
+        if (!ok) return EXIT_FAILURE;
+
     } catch (const std::exception& e) {
         // Handle errors and display usage help
         std::cerr << "\nError: " << e.what() << "\n\n";